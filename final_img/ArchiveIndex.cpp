@@ -0,0 +1,316 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include "ArchiveIndex.h"
+#include "Format.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace img
+{
+	static_assert(sizeof(ArchiveRecord) == 64, "ArchiveRecord must keep its on-disk size.");
+
+	const char ArchiveIndex::signature[8] = {'I', 'M', 'G', 'I', 'D', 'X', '0', '1'};
+
+	/**
+	* Cabecera del fichero del &iacute;ndice.
+	*/
+	struct ArchiveIndexHeader
+	{
+		char signature[8];
+		uint64_t count;
+		uint64_t stringsSize;
+	};
+
+	/**
+	* Un fichero IMG encontrado al recorrer el archivo, con su registro.
+	*/
+	struct ArchiveEntry
+	{
+		std::string path;
+		ArchiveRecord record;
+		bool valid;
+	};
+
+	/**
+	* Indica si la direcci&oacute;n tiene extensi&oacute;n .IMG, sin distinguir may&uacute;sculas.
+	*/
+	static bool isImgFile(const std::string &name)
+	{
+		if(name.size() < 4)
+			return false;
+
+		const char *extension = name.c_str() + name.size() - 4;
+
+		return extension[0] == '.' && (extension[1] == 'I' || extension[1] == 'i') &&
+			(extension[2] == 'M' || extension[2] == 'm') && (extension[3] == 'G' || extension[3] == 'g');
+	}
+
+	/**
+	* Agrega a la lista los ficheros IMG del directorio y de sus subdirectorios.
+	*/
+	static void collectFiles(const std::string &dir, std::vector<ArchiveEntry> &entries)
+	{
+#ifdef _WIN32
+		WIN32_FIND_DATAA data;
+		HANDLE find = FindFirstFileA((dir + "/*").c_str(), &data);
+		if(find == INVALID_HANDLE_VALUE)
+			return;
+
+		do
+		{
+			std::string name = data.cFileName;
+			if(name == "." || name == "..")
+				continue;
+
+			std::string path = dir + "/" + name;
+			if(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+				collectFiles(path, entries);
+			else if(isImgFile(name))
+			{
+				entries.push_back(ArchiveEntry());
+				entries.back().path = path;
+			}
+		}
+		while(FindNextFileA(find, &data));
+
+		FindClose(find);
+#else
+		DIR *directory = opendir(dir.c_str());
+		if(directory == NULL)
+			return;
+
+		while(struct dirent *entry = readdir(directory))
+		{
+			std::string name = entry->d_name;
+			if(name == "." || name == "..")
+				continue;
+
+			std::string path = dir + "/" + name;
+
+			bool isDirectory = entry->d_type == DT_DIR;
+			if(entry->d_type == DT_UNKNOWN)
+			{
+				struct stat info;
+				isDirectory = stat(path.c_str(), &info) == 0 && S_ISDIR(info.st_mode);
+			}
+
+			if(isDirectory)
+				collectFiles(path, entries);
+			else if(isImgFile(name))
+			{
+				entries.push_back(ArchiveEntry());
+				entries.back().path = path;
+			}
+		}
+
+		closedir(directory);
+#endif
+	}
+
+	/**
+	* Copia un texto en un campo de tama&ntilde;o fijo, completando con ceros.
+	*/
+	static void copyField(char *field, size_t size, const std::string &value)
+	{
+		memset(field, 0, size);
+		memcpy(field, value.data(), value.size() < size ? value.size() : size);
+	}
+
+	/**
+	* Lee la cabecera del fichero de la entrada y llena su registro.
+	*/
+	static void probeEntry(ArchiveEntry &entry)
+	{
+		ImageHeader header;
+		entry.valid = Format::probeHeader(entry.path.c_str(), header);
+
+		ArchiveRecord &record = entry.record;
+		memset(&record, 0, sizeof(record));
+
+		if(!entry.valid)
+			return;
+
+		copyField(record.systemId, sizeof(record.systemId), header.systemId);
+		copyField(record.date, sizeof(record.date), header.date);
+		copyField(record.model, sizeof(record.model), header.model);
+		record.sequenceNumber = (uint32_t)header.sequenceNumber;
+		record.width = (uint16_t)header.width;
+		record.height = (uint16_t)header.height;
+		record.rayIntensity = (uint16_t)(header.rayIntensity * 10.0 + 0.5);
+		record.formatType = header.formatType;
+	}
+
+	/**
+	* Orden de los registros en el &iacute;ndice: sistema, fecha, n&uacute;mero de secuencia y direcci&oacute;n.
+	*/
+	static bool entryLess(const ArchiveEntry &a, const ArchiveEntry &b)
+	{
+		int compare = memcmp(a.record.systemId, b.record.systemId, sizeof(a.record.systemId));
+		if(compare != 0)
+			return compare < 0;
+
+		compare = memcmp(a.record.date, b.record.date, sizeof(a.record.date));
+		if(compare != 0)
+			return compare < 0;
+
+		if(a.record.sequenceNumber != b.record.sequenceNumber)
+			return a.record.sequenceNumber < b.record.sequenceNumber;
+
+		return a.path < b.path;
+	}
+
+	size_t ArchiveIndex::build(const char *rootDir, const char *indexPath, int threads)
+	{
+		std::vector<ArchiveEntry> entries;
+		collectFiles(rootDir, entries);
+
+		//Cada hilo toma el siguiente fichero sin leer; las cabeceras se leen en paralelo para solapar los accesos al disco
+		std::atomic<size_t> next(0);
+		std::vector<std::thread> workers;
+		int workerCount = threads < 1 ? 1 : threads;
+
+		for(int k = 0; k < workerCount; k++)
+		{
+			workers.push_back(std::thread([&entries, &next]()
+			{
+				for(size_t index = next++; index < entries.size(); index = next++)
+					probeEntry(entries[index]);
+			}));
+		}
+
+		for(size_t k = 0; k < workers.size(); k++)
+			workers[k].join();
+
+		entries.erase(std::remove_if(entries.begin(), entries.end(), [](const ArchiveEntry &entry) { return !entry.valid; }), entries.end());
+		std::sort(entries.begin(), entries.end(), entryLess);
+
+		std::string strings;
+		for(size_t k = 0; k < entries.size(); k++)
+		{
+			entries[k].record.pathOffset = (uint32_t)strings.size();
+			entries[k].record.pathLength = (uint16_t)entries[k].path.size();
+			strings += entries[k].path;
+		}
+
+		ArchiveIndexHeader header;
+		memcpy(header.signature, signature, sizeof(signature));
+		header.count = entries.size();
+		header.stringsSize = strings.size();
+
+		std::ofstream file(indexPath, std::ios::binary);
+		if(!file)
+			throw invalid_argument("Archive index couldn't be created.");
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		for(size_t k = 0; k < entries.size(); k++)
+			file.write(reinterpret_cast<const char*>(&entries[k].record), sizeof(ArchiveRecord));
+		file.write(strings.data(), strings.size());
+
+		if(!file)
+			throw invalid_argument("Archive index couldn't be written.");
+
+		return entries.size();
+	}
+
+	ArchiveIndex::ArchiveIndex(const char *indexPath) :file(indexPath), records(NULL), count(0), strings(NULL)
+	{
+		if(!file.isOpen() || file.getSize() < sizeof(ArchiveIndexHeader))
+			return;
+
+		const ArchiveIndexHeader *header = reinterpret_cast<const ArchiveIndexHeader*>(file.getData());
+		if(memcmp(header->signature, signature, sizeof(signature)) != 0)
+			return;
+
+		//La cantidad se compara con la que cabe en el fichero antes de multiplicar, para que no desborde
+		uint64_t available = file.getSize() - sizeof(ArchiveIndexHeader);
+		if(header->count > available / sizeof(ArchiveRecord))
+			return;
+
+		uint64_t recordsSize = header->count * sizeof(ArchiveRecord);
+		if(header->stringsSize != available - recordsSize)
+			return;
+
+		const ArchiveRecord *first = reinterpret_cast<const ArchiveRecord*>(file.getData() + sizeof(ArchiveIndexHeader));
+
+		//Las direcciones se comprueban una vez aqu&iacute; para que getPath(size_t) no tenga que hacerlo
+		for(uint64_t k = 0; k < header->count; k++)
+			if((uint64_t)first[k].pathOffset + first[k].pathLength > header->stringsSize)
+				return;
+
+		count = (size_t)header->count;
+		records = first;
+		strings = reinterpret_cast<const char*>(file.getData() + sizeof(ArchiveIndexHeader) + recordsSize);
+	}
+
+	std::string ArchiveIndex::getPath(size_t index) const
+	{
+		const ArchiveRecord &record = records[index];
+
+		return std::string(strings + record.pathOffset, record.pathLength);
+	}
+
+	/**
+	* Clave de b&uacute;squeda en el &iacute;ndice: un sistema y el inicio de una fecha.
+	*/
+	struct ArchiveKey
+	{
+		char systemId[sizeof(ArchiveRecord::systemId)];
+		const char *datePrefix;
+		size_t dateLength;
+
+		static int compare(const ArchiveRecord &record, const ArchiveKey &key)
+		{
+			int result = memcmp(record.systemId, key.systemId, sizeof(key.systemId));
+
+			return result != 0 ? result : memcmp(record.date, key.datePrefix, key.dateLength);
+		}
+
+		bool operator()(const ArchiveRecord &record, const ArchiveKey &key) const { return compare(record, key) < 0; }
+		bool operator()(const ArchiveKey &key, const ArchiveRecord &record) const { return compare(record, key) > 0; }
+	};
+
+	size_t ArchiveIndex::find(const std::string &systemId, const std::string &datePrefix, size_t &first, size_t &last) const
+	{
+		first = last = 0;
+
+		if(records == NULL)
+			return 0;
+
+		ArchiveKey key;
+		copyField(key.systemId, sizeof(key.systemId), systemId);
+		key.datePrefix = datePrefix.data();
+		key.dateLength = datePrefix.size() < sizeof(records->date) ? datePrefix.size() : sizeof(records->date);
+
+		std::pair<const ArchiveRecord*, const ArchiveRecord*> range = std::equal_range(records, records + count, key, key);
+
+		first = range.first - records;
+		last = range.second - records;
+
+		return last - first;
+	}
+}
@@ -0,0 +1,182 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef ARCHIVEINDEX_H
+#define ARCHIVEINDEX_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+namespace img
+{
+	/**
+	* Registro de un fichero IMG en el &iacute;ndice del archivo. Tiene tama&ntilde;o fijo para que el
+	* &iacute;ndice pueda ser proyectado en memoria y buscado directamente. Los textos se guardan
+	* completados con ceros y sin terminador cuando ocupan todo el campo.
+	*/
+	struct ArchiveRecord
+	{
+		/**
+		* Identificador interno del sistema del equipo de Rayos X.
+		*/
+		char systemId[12];
+
+		/**
+		* Fecha en que fue creado el fichero IMG.
+		*/
+		char date[20];
+
+		/**
+		* Modelo del equipo de Rayos X.
+		*/
+		char model[12];
+
+		/**
+		* Posici&oacute;n de la direcci&oacute;n del fichero en la tabla de textos del &iacute;ndice.
+		*/
+		uint32_t pathOffset;
+
+		/**
+		* N&uacute;mero de secuencia. S&oacute;lo para el formato 1.
+		*/
+		uint32_t sequenceNumber;
+
+		/**
+		* Longitud de la direcci&oacute;n del fichero.
+		*/
+		uint16_t pathLength;
+
+		/**
+		* El ancho de la imagen.
+		*/
+		uint16_t width;
+
+		/**
+		* El alto de la imagen seg&uacute;n la cabecera.
+		*/
+		uint16_t height;
+
+		/**
+		* La intensidad de los rayos X en d&eacute;cimas de K/V.
+		*/
+		uint16_t rayIntensity;
+
+		/**
+		* Identificador del tipo de formato del fichero IMG.
+		*/
+		uint8_t formatType;
+
+		/**
+		* Relleno hasta 64 bytes.
+		*/
+		uint8_t reserved[3];
+	};
+
+	/**
+	* &Iacute;ndice compacto de los datos de cabecera de un &aacute;rbol de directorios de ficheros IMG.
+	* El &iacute;ndice se construye leyendo s&oacute;lo la cabecera de cada fichero con varios hilos y se guarda
+	* ordenado por sistema, fecha y n&uacute;mero de secuencia. Para consultarlo se proyecta en memoria, por lo
+	* que las b&uacute;squedas no abren ning&uacute;n fichero IMG.
+	*
+	* Estructura del fichero: una cabecera de 24 bytes (firma "IMGIDX01", cantidad de registros y tama&ntilde;o
+	* de la tabla de textos), los registros ArchiveRecord ordenados y la tabla de textos con las direcciones.
+	*/
+	class ArchiveIndex
+	{
+	private:
+		/**
+		* La proyecci&oacute;n del fichero del &iacute;ndice.
+		*/
+		MappedFile file;
+
+		/**
+		* Los registros del &iacute;ndice, NULL si el &iacute;ndice no es v&aacute;lido.
+		*/
+		const ArchiveRecord *records;
+
+		/**
+		* Cantidad de registros del &iacute;ndice.
+		*/
+		size_t count;
+
+		/**
+		* La tabla de textos del &iacute;ndice.
+		*/
+		const char *strings;
+
+		ArchiveIndex(const ArchiveIndex &);
+		ArchiveIndex &operator=(const ArchiveIndex &);
+
+	public:
+		/**
+		* Firma del fichero del &iacute;ndice.
+		*/
+		static const char signature[8];
+
+		/**
+		* Recorre un &aacute;rbol de directorios, lee la cabecera de cada fichero IMG y guarda el &iacute;ndice.
+		* Los ficheros que no tienen un formato IMG v&aacute;lido se ignoran.
+		* @param rootDir El directorio ra&iacute;z del archivo.
+		* @param indexPath La direcci&oacute;n del fichero del &iacute;ndice que se crea.
+		* @param threads La cantidad de hilos que leen las cabeceras.
+		* @return La cantidad de ficheros indexados.
+		*/
+		static size_t build(const char *rootDir, const char *indexPath, int threads = 8);
+
+		/**
+		* Constructor de la clase. Proyecta en memoria un &iacute;ndice creado con build(). Luego de creado el
+		* objeto se debe llamar el m&eacute;todo isOpen() para comprobar que el &iacute;ndice es v&aacute;lido: el tama&ntilde;o
+		* del fichero corresponde a la cantidad de registros y la direcci&oacute;n de cada registro est&aacute; dentro del fichero.
+		* @param indexPath La direcci&oacute;n del fichero del &iacute;ndice.
+		*/
+		ArchiveIndex(const char *indexPath);
+
+		/**
+		* Indica si el &iacute;ndice fue proyectado y es v&aacute;lido.
+		*/
+		inline bool isOpen() const { return this->records != NULL; }
+
+		/**
+		* Cantidad de registros del &iacute;ndice.
+		*/
+		inline size_t getCount() const { return this->count; }
+
+		/**
+		* Un registro del &iacute;ndice.
+		*/
+		inline const ArchiveRecord &getRecord(size_t index) const { return this->records[index]; }
+
+		/**
+		* La direcci&oacute;n del fichero de un registro.
+		*/
+		std::string getPath(size_t index) const;
+
+		/**
+		* Busca los registros de un sistema cuya fecha comienza con el texto dado, por ejemplo todas las
+		* im&aacute;genes del sistema X en el d&iacute;a Y. La b&uacute;squeda es binaria sobre los registros ordenados.
+		* @param systemId El identificador del sistema.
+		* @param datePrefix El inicio de la fecha, vac&iacute;o para todas las fechas.
+		* @param first La posici&oacute;n del primer registro encontrado.
+		* @param last La posici&oacute;n siguiente al &uacute;ltimo registro encontrado.
+		* @return La cantidad de registros encontrados.
+		*/
+		size_t find(const std::string &systemId, const std::string &datePrefix, size_t &first, size_t &last) const;
+	};
+}
+
+#endif // ARCHIVEINDEX_H
@@ -0,0 +1,361 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include <algorithm>
+#include "BatchLoader.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef IMG_USE_IO_URING
+#include <errno.h>
+#include <liburing.h>
+#endif
+
+namespace img
+{
+	/**
+	* Lee un fichero completo.
+	* @param path La direcci&oacute;n del fichero.
+	* @param bytes Los bytes del fichero, vac&iacute;o si no pudo ser le&iacute;do.
+	*/
+	static void readFile(const std::string &path, std::vector<byte> &bytes)
+	{
+		bytes.clear();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+		if(file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER fileSize;
+		if(GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			bytes.resize((size_t)fileSize.QuadPart);
+
+			size_t done = 0;
+			while(done < bytes.size())
+			{
+				DWORD count = 0;
+				DWORD wanted = (DWORD)std::min<size_t>(bytes.size() - done, 1 << 30);
+				if(!ReadFile(file, &bytes[done], wanted, &count, NULL) || count == 0)
+					break;
+
+				done += count;
+			}
+
+			bytes.resize(done);
+		}
+
+		CloseHandle(file);
+#else
+		int descriptor = open(path.c_str(), O_RDONLY);
+		if(descriptor < 0)
+			return;
+
+		struct stat info;
+		if(fstat(descriptor, &info) == 0 && info.st_size > 0)
+		{
+			bytes.resize((size_t)info.st_size);
+
+			size_t done = 0;
+			while(done < bytes.size())
+			{
+				ssize_t count = pread(descriptor, &bytes[done], bytes.size() - done, (off_t)done);
+				if(count <= 0)
+					break;
+
+				done += (size_t)count;
+			}
+
+			bytes.resize(done);
+		}
+
+		close(descriptor);
+#endif
+	}
+
+	BatchLoader::BatchLoader(const std::vector<std::string> &paths, int depth, int threads)
+		:paths(paths), slots(paths.size()), depth(depth < 1 ? 1 : depth), nextToConsume(0), nextToRead(0),
+		threadCount(threads < 1 ? 1 : threads), stopping(false), ring(NULL), inFlight(0)
+	{
+		if(startRing())
+		{
+			submitReads();
+			return;
+		}
+
+		startWorkers();
+	}
+
+	void BatchLoader::startWorkers(void)
+	{
+		for(int k = 0; k < threadCount; k++)
+			workers.push_back(std::thread(&BatchLoader::work, this));
+	}
+
+	BatchLoader::~BatchLoader()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stopping = true;
+		}
+
+		changed.notify_all();
+
+		//Los buffers de las lecturas en curso deben existir hasta que terminen. Si la cola falla mientras se
+		//espera, completeRead la cierra y crea hilos que terminan enseguida, por lo que los hilos se esperan despu&eacute;s
+		while(ring != NULL && inFlight > 0)
+			completeRead();
+
+		if(ring != NULL)
+			stopRing();
+
+		for(size_t k = 0; k < workers.size(); k++)
+			workers[k].join();
+	}
+
+	bool BatchLoader::next(std::string &path, std::vector<byte> &bytes)
+	{
+		if(nextToConsume >= paths.size())
+			return false;
+
+		size_t index = nextToConsume;
+
+		while(ring != NULL && !slots[index].ready)
+			completeRead();
+
+		//Sin io_uring, o si la cola fall&oacute; mientras se esperaba, los ficheros los leen los hilos
+		if(ring == NULL)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			while(!slots[index].ready)
+				changed.wait(lock);
+		}
+
+		path = paths[index];
+		bytes.clear();
+		bytes.swap(slots[index].bytes);
+		std::vector<byte>().swap(slots[index].bytes);
+
+		if(ring != NULL)
+		{
+			nextToConsume++;
+			submitReads();
+		}
+		else
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				nextToConsume++;
+			}
+
+			changed.notify_all();
+		}
+
+		return true;
+	}
+
+	void BatchLoader::work(void)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+
+		while(true)
+		{
+			//Se leen como m&aacute;ximo depth ficheros por delante del que se est&aacute; decodificando
+			while(!stopping && nextToRead < paths.size() && nextToRead >= nextToConsume + depth)
+				changed.wait(lock);
+
+			if(stopping || nextToRead >= paths.size())
+				return;
+
+			size_t index = nextToRead++;
+			lock.unlock();
+
+			std::vector<byte> bytes;
+			readFile(paths[index], bytes);
+
+			lock.lock();
+			slots[index].bytes.swap(bytes);
+			slots[index].ready = true;
+			changed.notify_all();
+		}
+	}
+
+#ifdef IMG_USE_IO_URING
+	bool BatchLoader::startRing(void)
+	{
+		io_uring *queue = new io_uring;
+
+		if(io_uring_queue_init((unsigned)depth, queue, 0) < 0)
+		{
+			delete queue;
+			return false;
+		}
+
+		ring = queue;
+		return true;
+	}
+
+	void BatchLoader::stopRing(void)
+	{
+		io_uring *queue = static_cast<io_uring*>(ring);
+
+		//Primero se cierra la cola: el n&uacute;cleo no escribe en los buffers despu&eacute;s de io_uring_queue_exit
+		io_uring_queue_exit(queue);
+		delete queue;
+		ring = NULL;
+		inFlight = 0;
+
+		for(size_t k = 0; k < slots.size(); k++)
+		{
+			if(slots[k].descriptor >= 0)
+			{
+				close(slots[k].descriptor);
+				slots[k].descriptor = -1;
+			}
+		}
+	}
+
+	void BatchLoader::submitReads(void)
+	{
+		io_uring *queue = static_cast<io_uring*>(ring);
+		bool submitted = false;
+
+		while(nextToRead < paths.size() && nextToRead < nextToConsume + depth)
+		{
+			size_t index = nextToRead++;
+			Slot &slot = slots[index];
+
+			slot.descriptor = open(paths[index].c_str(), O_RDONLY);
+
+			struct stat info;
+			if(slot.descriptor < 0 || fstat(slot.descriptor, &info) != 0 || info.st_size <= 0)
+			{
+				if(slot.descriptor >= 0)
+					close(slot.descriptor);
+
+				slot.descriptor = -1;
+				slot.ready = true;
+				continue;
+			}
+
+			slot.bytes.resize((size_t)info.st_size);
+
+			io_uring_sqe *entry = io_uring_get_sqe(queue);
+			io_uring_prep_read(entry, slot.descriptor, &slot.bytes[0], (unsigned)slot.bytes.size(), 0);
+			io_uring_sqe_set_data(entry, reinterpret_cast<void*>(index));
+			inFlight++;
+			submitted = true;
+		}
+
+		if(submitted)
+			io_uring_submit(queue);
+	}
+
+	void BatchLoader::completeRead(void)
+	{
+		io_uring *queue = static_cast<io_uring*>(ring);
+		io_uring_cqe *completion;
+
+		int error = io_uring_wait_cqe(queue, &completion);
+		if(error == -EINTR)
+			return;
+
+		if(error < 0)
+		{
+			//La cola no responde: se cierra antes de tocar los buffers, porque el n&uacute;cleo puede seguir
+			//escribiendo en ellos hasta entonces. Las lecturas enviadas se dan por fallidas
+			std::vector<bool> pending(slots.size());
+			for(size_t k = 0; k < slots.size(); k++)
+				pending[k] = slots[k].descriptor >= 0 && !slots[k].ready;
+
+			stopRing();
+
+			std::lock_guard<std::mutex> lock(mutex);
+
+			for(size_t k = 0; k < slots.size(); k++)
+			{
+				if(pending[k])
+				{
+					std::vector<byte>().swap(slots[k].bytes);
+					slots[k].done = 0;
+					slots[k].ready = true;
+				}
+			}
+
+			//Los ficheros que no se enviaron a la cola los leen los hilos
+			if(!stopping)
+				startWorkers();
+
+			return;
+		}
+
+		size_t index = reinterpret_cast<size_t>(io_uring_cqe_get_data(completion));
+		int result = completion->res;
+		io_uring_cqe_seen(queue, completion);
+		inFlight--;
+
+		Slot &slot = slots[index];
+
+		if(result > 0)
+			slot.done += (size_t)result;
+
+		if(result > 0 && slot.done < slot.bytes.size())
+		{
+			//Lectura incompleta: se pide el resto del fichero
+			io_uring_sqe *entry = io_uring_get_sqe(queue);
+			io_uring_prep_read(entry, slot.descriptor, &slot.bytes[slot.done], (unsigned)(slot.bytes.size() - slot.done), slot.done);
+			io_uring_sqe_set_data(entry, reinterpret_cast<void*>(index));
+			io_uring_submit(queue);
+			inFlight++;
+			return;
+		}
+
+		if(result < 0)
+			slot.done = 0;
+
+		slot.bytes.resize(slot.done);
+		close(slot.descriptor);
+		slot.descriptor = -1;
+		slot.ready = true;
+	}
+#else
+	bool BatchLoader::startRing(void)
+	{
+		return false;
+	}
+
+	void BatchLoader::stopRing(void)
+	{
+	}
+
+	void BatchLoader::submitReads(void)
+	{
+	}
+
+	void BatchLoader::completeRead(void)
+	{
+	}
+#endif
+}
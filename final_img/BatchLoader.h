@@ -0,0 +1,210 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef BATCHLOADER_H
+#define BATCHLOADER_H
+
+#include <stddef.h>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+typedef unsigned char byte;
+
+namespace img
+{
+	/**
+	* Cargador de una lista de ficheros IMG que lee por adelantado los pr&oacute;ximos ficheros mientras se
+	* decodifica el actual, para que el disco y el procesador trabajen a la vez. Como m&aacute;ximo hay depth
+	* ficheros le&iacute;dos o en lectura que a&uacute;n no han sido entregados.
+	*
+	* Si se compila con IMG_USE_IO_URING (y se enlaza con liburing) las lecturas se env&iacute;an al n&uacute;cleo
+	* con io_uring desde el hilo que llama next(). Si io_uring no est&aacute; disponible se utilizan hilos que
+	* leen con pread (ReadFile en Windows).
+	*
+	* Ejemplo de uso:
+	* <pre>
+	* BatchLoader loader(paths);
+	* std::string path;
+	* std::vector<byte> bytes;
+	* while(loader.next(path, bytes))
+	* {
+	*     BufferSource source(bytes);
+	*     Format format(source);
+	*     ...
+	* }
+	* </pre>
+	*/
+	class BatchLoader
+	{
+	private:
+		/**
+		* Estado de la lectura de un fichero.
+		*/
+		struct Slot
+		{
+			/**
+			* Los bytes del fichero.
+			*/
+			std::vector<byte> bytes;
+
+			/**
+			* Descriptor del fichero mientras se lee con io_uring.
+			*/
+			int descriptor;
+
+			/**
+			* Cantidad de bytes le&iacute;dos con io_uring.
+			*/
+			size_t done;
+
+			/**
+			* Indica que el fichero ya fue le&iacute;do (o que la lectura fall&oacute; y bytes est&aacute; vac&iacute;o).
+			*/
+			bool ready;
+
+			Slot() :descriptor(-1), done(0), ready(false) {}
+		};
+
+		/**
+		* Las direcciones de los ficheros.
+		*/
+		std::vector<std::string> paths;
+
+		/**
+		* El estado de la lectura de cada fichero.
+		*/
+		std::vector<Slot> slots;
+
+		/**
+		* Cantidad m&aacute;xima de ficheros le&iacute;dos por adelantado.
+		*/
+		size_t depth;
+
+		/**
+		* Posici&oacute;n del pr&oacute;ximo fichero que se entrega.
+		*/
+		size_t nextToConsume;
+
+		/**
+		* Posici&oacute;n del pr&oacute;ximo fichero que se comienza a leer.
+		*/
+		size_t nextToRead;
+
+		/**
+		* Cantidad de hilos de lectura cuando no se utiliza io_uring.
+		*/
+		int threadCount;
+
+		/**
+		* Indica que el objeto se est&aacute; destruyendo y los hilos deben terminar.
+		*/
+		bool stopping;
+
+		/**
+		* Protege el estado compartido con los hilos de lectura.
+		*/
+		std::mutex mutex;
+
+		/**
+		* Avisa de un fichero le&iacute;do o entregado.
+		*/
+		std::condition_variable changed;
+
+		/**
+		* Los hilos de lectura, vac&iacute;o mientras se utiliza io_uring.
+		*/
+		std::vector<std::thread> workers;
+
+		/**
+		* La cola de io_uring, NULL si no se utiliza.
+		*/
+		void *ring;
+
+		/**
+		* Cantidad de lecturas enviadas a io_uring que no han terminado.
+		*/
+		size_t inFlight;
+
+		BatchLoader(const BatchLoader &);
+		BatchLoader &operator=(const BatchLoader &);
+
+	public:
+		/**
+		* Constructor de la clase. Comienza a leer los primeros ficheros de la lista.
+		* @param paths Las direcciones de los ficheros en el orden en que se entregar&aacute;n.
+		* @param depth Cantidad m&aacute;xima de ficheros le&iacute;dos por adelantado.
+		* @param threads Cantidad de hilos de lectura cuando no se utiliza io_uring.
+		*/
+		BatchLoader(const std::vector<std::string> &paths, int depth = 4, int threads = 2);
+
+		/**
+		* Destructor de la clase. Espera a que terminen las lecturas en curso.
+		*/
+		~BatchLoader();
+
+		/**
+		* Entrega el pr&oacute;ximo fichero de la lista, esperando a que termine su lectura si es necesario.
+		* @param path La direcci&oacute;n del fichero.
+		* @param bytes Los bytes del fichero, vac&iacute;o si no pudo ser le&iacute;do. El contenido anterior se descarta.
+		* @return false si ya se entregaron todos los ficheros.
+		*/
+		bool next(std::string &path, std::vector<byte> &bytes);
+
+		/**
+		* Indica si las lecturas se hacen con io_uring.
+		*/
+		inline bool usesIoUring() const { return this->ring != NULL; }
+
+	private:
+		/**
+		* Cuerpo de los hilos de lectura.
+		*/
+		void work(void);
+
+		/**
+		* Crea los hilos de lectura.
+		*/
+		void startWorkers(void);
+
+		/**
+		* Inicializa la cola de io_uring.
+		* @return false si io_uring no est&aacute; disponible.
+		*/
+		bool startRing(void);
+
+		/**
+		* Cierra la cola de io_uring, lo que espera a que el n&uacute;cleo termine las lecturas en curso, y luego
+		* cierra los descriptores de los ficheros. Los bytes de las lecturas que no terminaron no se modifican.
+		*/
+		void stopRing(void);
+
+		/**
+		* Env&iacute;a a io_uring la lectura de los ficheros que caben en la ventana de lectura por adelantado.
+		*/
+		void submitReads(void);
+
+		/**
+		* Espera y procesa una lectura terminada de io_uring. Si la cola falla se cierra, las lecturas en curso
+		* se dan por fallidas y los ficheros restantes se leen con hilos.
+		*/
+		void completeRead(void);
+	};
+}
+
+#endif // BATCHLOADER_H
@@ -0,0 +1,117 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef BYTEREADER_H
+#define BYTEREADER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+typedef unsigned char byte;
+
+namespace img
+{
+	/**
+	* Lector de enteros little-endian sobre un bloque de bytes. El rango de un registro completo se
+	* comprueba una sola vez con covers(size_t, size_t) y luego sus campos se leen sin comprobaciones,
+	* con lecturas no alineadas de 2 y 4 bytes. Las posiciones empiezan en 0, a diferencia de
+	* Format::read1Byte(int).
+	*/
+	class ByteReader
+	{
+	private:
+		/**
+		* El primer byte del bloque.
+		*/
+		const byte *data;
+
+		/**
+		* Cantidad de bytes del bloque.
+		*/
+		size_t size;
+
+	public:
+		/**
+		* Constructor de la clase.
+		* @param data El primer byte del bloque.
+		* @param size Cantidad de bytes del bloque.
+		*/
+		ByteReader(const byte *data, size_t size) :data(data), size(size) {}
+
+		/**
+		* Indica si los bytes desde offset hasta offset + count est&aacute;n dentro del bloque.
+		* @param offset La posici&oacute;n del primer byte.
+		* @param count Cantidad de bytes.
+		*/
+		inline bool covers(size_t offset, size_t count) const { return offset <= size && count <= size - offset; }
+
+		/**
+		* Puntero al byte de la posici&oacute;n dada, sin comprobar el rango.
+		*/
+		inline const byte *at(size_t offset) const { return data + offset; }
+
+		/**
+		* Lee un byte sin comprobar el rango.
+		*/
+		inline uint8_t read8(size_t offset) const { return data[offset]; }
+
+		/**
+		* Lee un entero de 2 bytes little-endian sin comprobar el rango.
+		*/
+		inline uint16_t read16(size_t offset) const
+		{
+			uint16_t value;
+			memcpy(&value, data + offset, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			value = (uint16_t)((value >> 8) | (value << 8));
+#endif
+			return value;
+		}
+
+		/**
+		* Lee un entero de 4 bytes little-endian sin comprobar el rango.
+		*/
+		inline uint32_t read32(size_t offset) const
+		{
+			uint32_t value;
+			memcpy(&value, data + offset, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			value = (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+#endif
+			return value;
+		}
+
+		/**
+		* Lee un texto de caracteres de 2 bytes, de los que s&oacute;lo se conserva el byte menos significativo,
+		* sin comprobar el rango.
+		* @param offset La posici&oacute;n del primer car&aacute;cter.
+		* @param count Cantidad de caracteres.
+		*/
+		inline std::string readString(size_t offset, size_t count) const
+		{
+			std::string text(count, '\0');
+
+			for(size_t k = 0; k < count; k++)
+				text[k] = (char)data[offset + k * 2];
+
+			return text;
+		}
+	};
+}
+
+#endif // BYTEREADER_H
@@ -0,0 +1,54 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include "ByteSource.h"
+
+namespace img
+{
+	BufferSource::BufferSource(std::vector<byte> &bytes)
+	{
+		buffer.swap(bytes);
+	}
+
+	SpanSource::SpanSource(const byte *data, size_t size) :data(data), size(size)
+	{
+	}
+
+	MappedSource::MappedSource(const char *path) :file(path)
+	{
+	}
+
+	StreamSource::StreamSource(std::istream &stream, size_t chunkSize) :stream(stream), size(0), chunkSize(chunkSize)
+	{
+	}
+
+	bool StreamSource::request(size_t size)
+	{
+		while(this->size < size && stream.good())
+		{
+			size_t wanted = size - this->size;
+			wanted = wanted < chunkSize ? chunkSize : wanted;
+
+			if(buffer.size() < this->size + wanted)
+				buffer.resize(this->size + wanted);
+
+			stream.read(reinterpret_cast<char*>(&buffer[this->size]), wanted);
+			this->size += (size_t)stream.gcount();
+		}
+
+		return size <= this->size;
+	}
+}
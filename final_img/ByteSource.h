@@ -0,0 +1,182 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef BYTESOURCE_H
+#define BYTESOURCE_H
+
+#include <stddef.h>
+#include <istream>
+#include <vector>
+#include "MappedFile.h"
+
+typedef unsigned char byte;
+
+namespace img
+{
+	/**
+	* Origen de los bytes de un fichero IMG. Permite decodificar el formato desde cualquier lugar donde
+	* se encuentren los bytes (un buffer propio, un bloque de memoria ajeno, una proyecci&oacute;n de un
+	* fichero o un flujo que se lee incrementalmente) sin copiarlos.
+	*/
+	class ByteSource
+	{
+	public:
+		/**
+		* Destructor de la clase.
+		*/
+		virtual ~ByteSource() {}
+
+		/**
+		* Puntero al primer byte disponible. Puede cambiar luego de una llamada a request(size_t).
+		*/
+		virtual const byte *getData() const = 0;
+
+		/**
+		* Cantidad de bytes disponibles actualmente.
+		*/
+		virtual size_t getSize() const = 0;
+
+		/**
+		* Solicita que al menos la cantidad de bytes dada est&eacute; disponible. Los or&iacute;genes que ya
+		* tienen todos sus bytes en memoria s&oacute;lo comprueban el tama&ntilde;o.
+		* @param size La cantidad de bytes que se necesitan desde el inicio.
+		* @return true si la cantidad de bytes pedida est&aacute; disponible.
+		*/
+		virtual bool request(size_t size) { return size <= getSize(); }
+	};
+
+	/**
+	* Origen de bytes que es due&ntilde;o de un buffer en memoria.
+	*/
+	class BufferSource : public ByteSource
+	{
+	private:
+		/**
+		* Los bytes del fichero IMG.
+		*/
+		std::vector<byte> buffer;
+
+	public:
+		/**
+		* Constructor de la clase. Toma el contenido del vector pasado por par&aacute;metro sin copiarlo,
+		* el vector queda vac&iacute;o.
+		* @param bytes Los bytes del fichero IMG.
+		*/
+		BufferSource(std::vector<byte> &bytes);
+
+		const byte *getData() const { return buffer.empty() ? NULL : &buffer[0]; }
+		size_t getSize() const { return buffer.size(); }
+	};
+
+	/**
+	* Origen de bytes que hace referencia a un bloque de memoria ajeno. El bloque debe mantenerse
+	* v&aacute;lido mientras se utilice el origen.
+	*/
+	class SpanSource : public ByteSource
+	{
+	private:
+		/**
+		* Puntero al primer byte del bloque.
+		*/
+		const byte *data;
+
+		/**
+		* Cantidad de bytes del bloque.
+		*/
+		size_t size;
+
+	public:
+		/**
+		* Constructor de la clase.
+		* @param data Puntero al primer byte del bloque.
+		* @param size Cantidad de bytes del bloque.
+		*/
+		SpanSource(const byte *data, size_t size);
+
+		const byte *getData() const { return data; }
+		size_t getSize() const { return size; }
+	};
+
+	/**
+	* Origen de bytes a partir de la proyecci&oacute;n en memoria de un fichero.
+	*/
+	class MappedSource : public ByteSource
+	{
+	private:
+		/**
+		* La proyecci&oacute;n del fichero.
+		*/
+		MappedFile file;
+
+	public:
+		/**
+		* Constructor de la clase. Luego de creado el objeto se debe llamar el m&eacute;todo isOpen()
+		* para comprobar que el fichero fue proyectado.
+		* @param path La direcci&oacute;n del fichero.
+		*/
+		MappedSource(const char *path);
+
+		/**
+		* Indica si el fichero fue proyectado en memoria.
+		*/
+		inline bool isOpen() const { return file.isOpen(); }
+
+		const byte *getData() const { return file.getData(); }
+		size_t getSize() const { return file.getSize(); }
+	};
+
+	/**
+	* Origen de bytes que se leen incrementalmente de un flujo (un socket, un fichero comprimido, etc.).
+	* Los bytes se leen s&oacute;lo a medida que son solicitados y se acumulan en un buffer interno.
+	*/
+	class StreamSource : public ByteSource
+	{
+	private:
+		/**
+		* El flujo de donde se leen los bytes.
+		*/
+		std::istream &stream;
+
+		/**
+		* Los bytes le&iacute;dos hasta el momento.
+		*/
+		std::vector<byte> buffer;
+
+		/**
+		* Cantidad de bytes v&aacute;lidos en el buffer.
+		*/
+		size_t size;
+
+		/**
+		* Cantidad m&iacute;nima de bytes que se leen del flujo en cada lectura.
+		*/
+		size_t chunkSize;
+
+	public:
+		/**
+		* Constructor de la clase.
+		* @param stream El flujo de donde se leen los bytes, debe mantenerse v&aacute;lido mientras se utilice el origen.
+		* @param chunkSize Cantidad m&iacute;nima de bytes que se leen del flujo en cada lectura.
+		*/
+		StreamSource(std::istream &stream, size_t chunkSize = 64 * 1024);
+
+		const byte *getData() const { return buffer.empty() ? NULL : &buffer[0]; }
+		size_t getSize() const { return size; }
+		bool request(size_t size);
+	};
+}
+
+#endif // BYTESOURCE_H
@@ -0,0 +1,358 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include "Calibration.h"
+#include "ByteReader.h"
+#include "HSIColorTable.h"
+#include "HueTable.h"
+
+namespace img
+{
+	/**
+	* Firma del fichero de calibraci&oacute;n, seguida de la versi&oacute;n del formato.
+	*/
+	static const char signature[6] = {'I', 'M', 'G', 'C', 'A', 'L'};
+	static const uint16_t version = 1;
+
+	Calibration::Calibration(const double *hCurve, const double *iCurve, const double *sMatrix)
+		:file(NULL), hCurve(hCurve), iCurve(iCurve), sMatrix(sMatrix)
+	{
+	}
+
+	Calibration::Calibration(const char *path)
+		:file(new MappedFile(path)), hCurve(NULL), iCurve(NULL), sMatrix(NULL)
+	{
+		if(!file->isOpen())
+		{
+			delete file;
+			throw std::invalid_argument("Calibration file couldn't be opened.");
+		}
+
+		ByteReader reader(file->getData(), file->getSize());
+
+		if(!reader.covers(0, headerSize) || memcmp(reader.at(0), signature, sizeof(signature)) != 0 || reader.read16(6) != version
+			|| reader.read32(8) != (uint32_t)hCurveSize || reader.read32(12) != (uint32_t)iCurveSize
+			|| reader.read32(16) != (uint32_t)sMatrixColumns || file->getSize() != headerSize + valueCount * sizeof(double))
+		{
+			delete file;
+			throw std::invalid_argument("Invalid calibration file.");
+		}
+
+		const double *first = reinterpret_cast<const double*>(reader.at(headerSize));
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+		//Los valores del fichero son little-endian: se copian invirtiendo los bytes
+		values.resize(valueCount);
+		for(int k = 0; k < valueCount; k++)
+		{
+			byte swapped[sizeof(double)];
+			for(size_t b = 0; b < sizeof(double); b++)
+				swapped[b] = reader.at(headerSize + k * sizeof(double))[sizeof(double) - 1 - b];
+			memcpy(&values[k], swapped, sizeof(double));
+		}
+		first = &values[0];
+#endif
+
+		//Los valores de las tablas est&aacute;n entre 0 y 1: fuera de ese intervalo (o NaN) no tienen sentido como
+		//colores y su conversi&oacute;n a punto fijo no est&aacute; definida. La comparaci&oacute;n es falsa para NaN
+		for(int k = 0; k < valueCount; k++)
+		{
+			if(!(first[k] >= 0 && first[k] <= 1))
+			{
+				delete file;
+				throw std::invalid_argument("Invalid calibration file.");
+			}
+		}
+
+		//La proyecci&oacute;n empieza en una p&aacute;gina y la cabecera ocupa 24 bytes: los valores est&aacute;n alineados
+		hCurve = first;
+		iCurve = hCurve + hCurveSize;
+		sMatrix = iCurve + iCurveSize;
+	}
+
+	Calibration::~Calibration()
+	{
+		delete file;
+	}
+
+	const float *Calibration::getSingleValues(void) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(singleValues.empty())
+		{
+			singleValues.resize(valueCount + 1, 0);
+			float *result = &singleValues[0];
+
+			for(int k = 0; k < hCurveSize; k++)
+				*result++ = (float)hCurve[k];
+			for(int k = 0; k < iCurveSize; k++)
+				*result++ = (float)iCurve[k];
+			for(int k = 0; k < iCurveSize * sMatrixColumns; k++)
+				*result++ = (float)sMatrix[k];
+		}
+
+		return &singleValues[0];
+	}
+
+	const uint16_t *Calibration::getFixedValues(void) const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(fixedValues.empty())
+		{
+			//Un valor 0 adicional permite leer el &uacute;ltimo valor de 16 bits con una lectura de 32 bits
+			fixedValues.resize(valueCount + 1, 0);
+			uint16_t *result = &fixedValues[0];
+
+			for(int k = 0; k < hCurveSize; k++)
+				*result++ = (uint16_t)(hCurve[k] * HSIColorTable::fixedOne + 0.5);
+			for(int k = 0; k < iCurveSize; k++)
+				*result++ = (uint16_t)(iCurve[k] * HSIColorTable::fixedOne + 0.5);
+			for(int k = 0; k < iCurveSize * sMatrixColumns; k++)
+				*result++ = (uint16_t)(sMatrix[k] * HSIColorTable::fixedOne + 0.5);
+		}
+
+		return &fixedValues[0];
+	}
+
+	bool Calibration::hasConstantHue(void) const
+	{
+		int lastColumn = sMatrixColumns - 1;
+		for(int k = lastColumn + 1; k < hCurveSize; k++)
+			if(hCurve[k] != hCurve[lastColumn])
+				return false;
+
+		return true;
+	}
+
+	const uint16_t *Calibration::getFusedValues(void) const
+	{
+		if(!hasConstantHue())
+			return NULL;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(fusedValues.empty())
+		{
+			fusedValues.resize((size_t)iCurveSize * sMatrixColumns * 4, 0);
+			uint16_t *result = &fusedValues[0];
+
+			for(int i = 0; i < iCurveSize; i++)
+			{
+				for(int c = 0; c < sMatrixColumns; c++, result += 4)
+				{
+					result[0] = (uint16_t)(hCurve[c] * HSIColorTable::fixedOne + 0.5);
+					result[1] = (uint16_t)(sMatrix[i * sMatrixColumns + c] * HSIColorTable::fixedOne + 0.5);
+					result[2] = (uint16_t)(iCurve[i] * HSIColorTable::fixedOne + 0.5);
+				}
+			}
+		}
+
+		return &fusedValues[0];
+	}
+
+	const byte *Calibration::getColorValues(int &columns) const
+	{
+		columns = hasConstantHue() ? sMatrixColumns : hCurveSize;
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if(colorValues.empty())
+		{
+			HSIColorTable table(*this);
+			HueTable hues(table);
+
+			colorValues.resize((size_t)iCurveSize * columns * 4, 0);
+			byte *result = &colorValues[0];
+
+			for(int i = 0; i < iCurveSize; i++)
+			{
+				for(int c = 0; c < columns; c++, result += 4)
+				{
+					double rgb[3];
+					hues.convert(c, sMatrix[i * sMatrixColumns + (c < sMatrixColumns - 1 ? c : sMatrixColumns - 1)], iCurve[i], rgb);
+
+					//Se truncan como al pasar la imagen a 8 bits, para dar el mismo color con y sin la tabla
+					result[0] = (byte)rgb[2];
+					result[1] = (byte)rgb[1];
+					result[2] = (byte)rgb[0];
+				}
+			}
+		}
+
+		return &colorValues[0];
+	}
+
+	/**
+	* Escribe valores double little-endian.
+	*/
+	static void writeValues(std::ofstream &file, const double *values, int count)
+	{
+		for(int k = 0; k < count; k++)
+		{
+			byte bytes[sizeof(double)];
+			memcpy(bytes, &values[k], sizeof(double));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			for(size_t b = 0; b < sizeof(double) / 2; b++)
+				std::swap(bytes[b], bytes[sizeof(double) - 1 - b]);
+#endif
+			file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+		}
+	}
+
+	/**
+	* Escribe un entero little-endian de 2 o 4 bytes.
+	*/
+	static void writeInteger(std::ofstream &file, uint32_t value, size_t size)
+	{
+		for(size_t b = 0; b < size; b++)
+			file.put((char)((value >> (8 * b)) & 0xFF));
+	}
+
+	bool Calibration::save(const char *path, const double *hCurve, const double *iCurve, const double *sMatrix)
+	{
+		std::ofstream file(path, std::ios::binary);
+		if(!file)
+			return false;
+
+		file.write(signature, sizeof(signature));
+		writeInteger(file, version, 2);
+		writeInteger(file, hCurveSize, 4);
+		writeInteger(file, iCurveSize, 4);
+		writeInteger(file, sMatrixColumns, 4);
+		writeInteger(file, 0, 4);
+
+		writeValues(file, hCurve, hCurveSize);
+		writeValues(file, iCurve, iCurveSize);
+		writeValues(file, sMatrix, iCurveSize * sMatrixColumns);
+
+		return file.good();
+	}
+
+	/**
+	* Las calibraciones cargadas por modelo y el directorio de los ficheros. Se crean la primera vez que se
+	* utilizan para no depender del orden de inicializaci&oacute;n de las variables globales.
+	*/
+	struct CalibrationCache
+	{
+		std::mutex mutex;
+		std::string directory;
+		std::map<std::string, const Calibration*> calibrations;
+
+		/**
+		* El error de los modelos cuyo fichero no es correcto: el fichero s&oacute;lo se lee una vez.
+		*/
+		std::map<std::string, std::string> errors;
+
+		/**
+		* Las calibraciones de directorios anteriores, que las tablas de colores pueden seguir utilizando.
+		*/
+		std::vector<const Calibration*> retired;
+
+		~CalibrationCache()
+		{
+			for(std::map<std::string, const Calibration*>::const_iterator k = calibrations.begin(); k != calibrations.end(); ++k)
+				delete k->second;
+			for(size_t k = 0; k < retired.size(); k++)
+				delete retired[k];
+		}
+
+		static CalibrationCache &shared(void)
+		{
+			static CalibrationCache cache;
+			return cache;
+		}
+	};
+
+	void Calibration::setDirectory(const std::string &directory)
+	{
+		CalibrationCache &cache = CalibrationCache::shared();
+		std::lock_guard<std::mutex> lock(cache.mutex);
+
+		cache.directory = directory;
+
+		for(std::map<std::string, const Calibration*>::const_iterator k = cache.calibrations.begin(); k != cache.calibrations.end(); ++k)
+			if(k->second != NULL)
+				cache.retired.push_back(k->second);
+
+		cache.calibrations.clear();
+		cache.errors.clear();
+	}
+
+	const Calibration *Calibration::forModel(const std::string &model)
+	{
+		//El campo del modelo tiene longitud fija: se ignoran los espacios y caracteres nulos del final
+		size_t length = model.size();
+		while(length > 0 && (model[length - 1] == ' ' || model[length - 1] == '\0'))
+			length--;
+
+		if(length == 0)
+			return NULL;
+
+		//El modelo forma parte del nombre del fichero ("HI-SCAN 604.cal"): s&oacute;lo se aceptan letras,
+		//d&iacute;gitos, espacios, '-', '_' y '.'
+		for(size_t k = 0; k < length; k++)
+		{
+			char c = model[k];
+			bool allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == ' ' || c == '-' || c == '_' || c == '.';
+			if(!allowed || (k == 0 && c == '.'))
+				return NULL;
+		}
+
+		CalibrationCache &cache = CalibrationCache::shared();
+		std::lock_guard<std::mutex> lock(cache.mutex);
+
+		if(cache.directory.empty())
+			return NULL;
+
+		std::string name(model, 0, length);
+		std::map<std::string, const Calibration*>::const_iterator found = cache.calibrations.find(name);
+		if(found != cache.calibrations.end())
+			return found->second;
+
+		std::map<std::string, std::string>::const_iterator error = cache.errors.find(name);
+		if(error != cache.errors.end())
+			throw std::invalid_argument(error->second);
+
+		std::string path = cache.directory + "/" + name + ".cal";
+		const Calibration *calibration = NULL;
+
+		std::ifstream probe(path.c_str(), std::ios::binary);
+		if(probe)
+		{
+			probe.close();
+
+			try
+			{
+				calibration = new Calibration(path.c_str());
+			}
+			catch(const std::invalid_argument &e)
+			{
+				cache.errors[name] = e.what();
+				throw;
+			}
+		}
+
+		cache.calibrations[name] = calibration;
+		return calibration;
+	}
+}
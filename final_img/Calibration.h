@@ -0,0 +1,220 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+namespace img
+{
+	/**
+	* Calibraci&oacute;n de los colores de un modelo de equipo de Rayos X: la curva de mat&iacute;z, la curva de
+	* intensidad y la matriz de saturaci&oacute;n que utiliza HSIColorTable.
+	*
+	* Las calibraciones se guardan en ficheros binarios que se proyectan en memoria; los valores se leen
+	* directamente desde la proyecci&oacute;n, sin copiarlos. Estructura del fichero (enteros y reales little-endian):
+	* <pre>
+	* byte  0: "IMGCAL" y la versi&oacute;n del formato (2 bytes, 1)
+	* byte  8: cantidad de valores de la curva de mat&iacute;z (4 bytes, 256)
+	* byte 12: cantidad de valores de la curva de intensidad (4 bytes, 2048)
+	* byte 16: cantidad de columnas de la matriz de saturaci&oacute;n (4 bytes, 33)
+	* byte 20: reservado (4 bytes, 0)
+	* byte 24: la curva de mat&iacute;z, la curva de intensidad y la matriz de saturaci&oacute;n fila por fila (doubles)
+	* </pre>
+	*
+	* Format::loadImageData(int) elige la calibraci&oacute;n seg&uacute;n el modelo de la cabecera con forModel(const string&):
+	* el fichero del modelo es &lt;directorio&gt;/&lt;modelo&gt;.cal, y si no existe se utiliza la tabla de
+	* HSIColorTable compilada en el programa.
+	*/
+	class Calibration
+	{
+	public:
+		/**
+		* Cantidad de valores de la curva de mat&iacute;z: un valor por cada bch3.
+		*/
+		static const int hCurveSize = 256;
+
+		/**
+		* Cantidad de valores de la curva de intensidad: un valor por cada (bch1 << 3) + (bch0 >> 5).
+		*/
+		static const int iCurveSize = 2048;
+
+		/**
+		* Cantidad de columnas de la matriz de saturaci&oacute;n; tiene tantas filas como valores la curva de intensidad.
+		*/
+		static const int sMatrixColumns = 33;
+
+		/**
+		* Cantidad de valores de las curvas y la matriz.
+		*/
+		static const int valueCount = hCurveSize + iCurveSize + iCurveSize * sMatrixColumns;
+
+		/**
+		* Tama&ntilde;o de la cabecera del fichero.
+		*/
+		static const size_t headerSize = 24;
+
+	private:
+		/**
+		* El fichero proyectado en memoria, NULL si los valores no vienen de un fichero.
+		*/
+		MappedFile *file;
+
+		/**
+		* Los valores le&iacute;dos del fichero cuando no se pueden usar desde la proyecci&oacute;n (procesadores big-endian).
+		*/
+		std::vector<double> values;
+
+		/**
+		* Los valores de las curvas y la matriz.
+		*/
+		const double *hCurve, *iCurve, *sMatrix;
+
+		/**
+		* Protege el c&aacute;lculo de las copias de menor precisi&oacute;n.
+		*/
+		mutable std::mutex mutex;
+
+		/**
+		* Copias de menor precisi&oacute;n de las curvas y la matriz, una tras otra, vac&iacute;as hasta que se piden.
+		*/
+		mutable std::vector<float> singleValues;
+		mutable std::vector<uint16_t> fixedValues;
+
+		/**
+		* La tabla combinada de 16 bits en punto fijo, vac&iacute;a hasta que se pide.
+		*/
+		mutable std::vector<uint16_t> fusedValues;
+
+		/**
+		* La tabla de colores sin filtro, vac&iacute;a hasta que se pide.
+		*/
+		mutable std::vector<byte> colorValues;
+
+		/**
+		* Indica si la curva de mat&iacute;z es constante desde bch3 = 32, la &uacute;ltima columna de la matriz de saturaci&oacute;n.
+		*/
+		bool hasConstantHue(void) const;
+
+		Calibration(const Calibration &);
+		Calibration &operator=(const Calibration &);
+
+	public:
+		/**
+		* Constructor de la clase. Utiliza valores que existen mientras exista el objeto, sin copiarlos.
+		* @param hCurve Los valores de la curva de mat&iacute;z.
+		* @param iCurve Los valores de la curva de intensidad.
+		* @param sMatrix Los valores de la matriz de saturaci&oacute;n, fila por fila.
+		*/
+		Calibration(const double *hCurve, const double *iCurve, const double *sMatrix);
+
+		/**
+		* Constructor de la clase. Proyecta en memoria un fichero de calibraci&oacute;n.
+		* @param path La direcci&oacute;n del fichero.
+		* @throws invalid_argument Si el fichero no puede ser abierto, su estructura no es correcta o alg&uacute;n valor
+		* no est&aacute; entre 0 y 1.
+		*/
+		Calibration(const char *path);
+
+		/**
+		* Destructor de la clase.
+		*/
+		~Calibration();
+
+		/**
+		* Los valores de la curva de mat&iacute;z.
+		*/
+		inline const double *getHCurve() const { return this->hCurve; }
+
+		/**
+		* Los valores de la curva de intensidad.
+		*/
+		inline const double *getICurve() const { return this->iCurve; }
+
+		/**
+		* Los valores de la matriz de saturaci&oacute;n, fila por fila.
+		*/
+		inline const double *getSMatrix() const { return this->sMatrix; }
+
+		/**
+		* Devuelve los valores float de la curva de mat&iacute;z, la curva de intensidad y la matriz, uno tras otro.
+		* Se calculan la primera vez que se piden.
+		*/
+		const float *getSingleValues(void) const;
+
+		/**
+		* Devuelve los valores de 16 bits en punto fijo (v / HSIColorTable::fixedOne) de la curva de mat&iacute;z,
+		* la curva de intensidad y la matriz, uno tras otro, m&aacute;s un valor 0 al final. Se calculan la primera
+		* vez que se piden.
+		*/
+		const uint16_t *getFixedValues(void) const;
+
+		/**
+		* Devuelve la tabla combinada de 16 bits en punto fijo: para cada (indexI, min(bch3, 32)) los valores
+		* H, S, I y un 0 de relleno, 8 bytes alineados que se leen con un solo acceso a memoria. Se calcula la
+		* primera vez que se pide. S&oacute;lo existe si la curva de mat&iacute;z es constante desde bch3 = 32 (en la
+		* calibraci&oacute;n compilada lo es desde 30), porque el &iacute;ndice no distingue los valores de bch3 mayores.
+		* @return La tabla, o NULL si la curva de mat&iacute;z no es constante desde bch3 = 32.
+		*/
+		const uint16_t *getFusedValues(void) const;
+
+		/**
+		* Devuelve la tabla de colores para decodificar sin el filtro de realce de bordes: para cada (indexI, bch3)
+		* los valores B, G, R del pixel, truncados a enteros como al pasar la imagen a 8 bits, y un 0 de relleno. Si la curva de
+		* mat&iacute;z es constante desde bch3 = 32 la tabla tiene 33 columnas y se indexa con min(bch3, 32)
+		* (2048 * 33 * 4 bytes, 264 KB); si no, tiene 256 columnas (2 MB). Se calcula la primera vez que se pide.
+		* @param columns Cantidad de columnas de la tabla.
+		* @return La tabla, fila por fila: la entrada de un pixel es (indexI * columns + min(bch3, columns - 1)) * 4.
+		*/
+		const byte *getColorValues(int &columns) const;
+
+		/**
+		* Guarda un fichero de calibraci&oacute;n.
+		* @param path La direcci&oacute;n del fichero.
+		* @param hCurve Los valores de la curva de mat&iacute;z.
+		* @param iCurve Los valores de la curva de intensidad.
+		* @param sMatrix Los valores de la matriz de saturaci&oacute;n, fila por fila.
+		* @return Verdadero si el fichero se escribi&oacute; correctamente.
+		*/
+		static bool save(const char *path, const double *hCurve, const double *iCurve, const double *sMatrix);
+
+		/**
+		* Cambia el directorio de los ficheros de calibraci&oacute;n. Las calibraciones ya cargadas se guardan hasta
+		* que termina el programa, porque las tablas de colores que las utilizan pueden seguir existiendo.
+		* @param directory El directorio; vac&iacute;o para no cargar calibraciones.
+		*/
+		static void setDirectory(const std::string &directory);
+
+		/**
+		* Devuelve la calibraci&oacute;n de un modelo de equipo. El fichero se carga la primera vez que se pide el
+		* modelo y se guarda mientras exista el programa; tambi&eacute;n se recuerda que un modelo no tiene fichero o
+		* que su fichero no es correcto, para no leerlo de nuevo en cada imagen.
+		* @param model El modelo del equipo, como lo devuelve Format::getModel().
+		* @return La calibraci&oacute;n, o NULL si no hay directorio o el modelo no tiene fichero.
+		* @throws invalid_argument Si el fichero del modelo existe pero su estructura no es correcta; se lanza el
+		* mismo error en las siguientes llamadas con el modelo.
+		*/
+		static const Calibration *forModel(const std::string &model);
+	};
+}
+
+#endif // CALIBRATION_H
@@ -0,0 +1,146 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include <string.h>
+#include <fstream>
+#include "ColumnIndex.h"
+
+namespace img
+{
+	const char ColumnIndex::signature[8] = {'I', 'M', 'G', 'C', 'O', 'L', '0', '2'};
+
+	/**
+	* Cabecera del fichero del &iacute;ndice de columnas.
+	*/
+	struct ColumnIndexHeader
+	{
+		char signature[8];
+		uint64_t sourceSize;
+		uint32_t count;
+		int32_t dataHeight;
+		int32_t width;
+		int32_t height;
+		uint32_t startIndex;
+		uint32_t reserved;
+	};
+
+	/**
+	* Una columna en el fichero del &iacute;ndice de columnas.
+	*/
+	struct ColumnIndexRecord
+	{
+		uint32_t startByte;
+		uint16_t columnLength;
+		uint16_t zeroPadding;
+	};
+
+	ColumnIndex::ColumnIndex() :dataHeight(0)
+	{
+	}
+
+	void ColumnIndex::clear(void)
+	{
+		columns.clear();
+		dataHeight = 0;
+	}
+
+	void ColumnIndex::add(const ImageDataControl &column)
+	{
+		columns.push_back(column);
+
+		if(dataHeight < column.getColumnLength() + column.getZeroPadding())
+			dataHeight = column.getColumnLength() + column.getZeroPadding();
+	}
+
+	bool ColumnIndex::save(const char *path, uint64_t sourceSize, int width, int height, long startIndex) const
+	{
+		std::ofstream file(path, std::ios::binary);
+		if(!file)
+			return false;
+
+		ColumnIndexHeader header;
+		memcpy(header.signature, signature, sizeof(signature));
+		header.sourceSize = sourceSize;
+		header.count = (uint32_t)columns.size();
+		header.dataHeight = dataHeight;
+		header.width = width;
+		header.height = height;
+		header.startIndex = (uint32_t)startIndex;
+		header.reserved = 0;
+
+		std::vector<ColumnIndexRecord> records(columns.size());
+		for(size_t k = 0; k < columns.size(); k++)
+		{
+			records[k].startByte = (uint32_t)columns[k].getStartByte();
+			records[k].columnLength = (uint16_t)columns[k].getColumnLength();
+			records[k].zeroPadding = (uint16_t)columns[k].getZeroPadding();
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		if(!records.empty())
+			file.write(reinterpret_cast<const char*>(&records[0]), records.size() * sizeof(ColumnIndexRecord));
+
+		return file.good();
+	}
+
+	bool ColumnIndex::load(const char *path, uint64_t sourceSize, int width, int height, long startIndex)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if(!file)
+			return false;
+
+		ColumnIndexHeader header;
+		if(!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+
+		if(memcmp(header.signature, signature, sizeof(signature)) != 0 || header.sourceSize != sourceSize || header.width != width
+			|| header.height != height || header.startIndex != (uint32_t)startIndex)
+			return false;
+
+		//Una columna por cada columna de la imagen como m&aacute;ximo: un valor da&ntilde;ado no reserva memoria de m&aacute;s
+		if(header.count > (uint32_t)width)
+			return false;
+
+		std::vector<ColumnIndexRecord> records(header.count);
+		if(header.count > 0 && !file.read(reinterpret_cast<char*>(&records[0]), records.size() * sizeof(ColumnIndexRecord)))
+			return false;
+
+		//Las mismas comprobaciones que al leer las columnas del fichero IMG: cada columna cabe en el alto de la
+		//imagen y sus pixeles, que terminan en el byte startByte + 7 + 4 * columnLength (contando desde 1), en el fichero
+		for(size_t k = 0; k < records.size(); k++)
+		{
+			const ColumnIndexRecord &record = records[k];
+
+			if(record.startByte < (uint32_t)startIndex || record.zeroPadding + record.columnLength > height
+				|| (uint64_t)record.startByte + 7 + (uint64_t)record.columnLength * 4 > sourceSize)
+				return false;
+		}
+
+		clear();
+		columns.reserve(records.size());
+
+		for(size_t k = 0; k < records.size(); k++)
+			add(ImageDataControl(records[k].startByte, records[k].columnLength, records[k].zeroPadding));
+
+		if(dataHeight != header.dataHeight)
+		{
+			clear();
+			return false;
+		}
+
+		return true;
+	}
+}
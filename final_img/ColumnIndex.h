@@ -0,0 +1,114 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef COLUMNINDEX_H
+#define COLUMNINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "ImageDataControl.h"
+
+namespace img
+{
+	/**
+	* &Iacute;ndice de las columnas del campo de datos de un fichero IMG. Guarda la estructura ImageDataControl
+	* de cada columna, lo que permite ir directamente al byte donde comienza cualquier columna sin recorrer
+	* las anteriores. Puede guardarse junto al fichero IMG para no tener que construirlo de nuevo.
+	*
+	* Estructura del fichero: firma "IMGCOL02", tama&ntilde;o del fichero IMG (8 bytes), cantidad de columnas, alto
+	* de los datos, ancho y alto de la cabecera y byte de inicio de los datos (4 bytes cada uno), 4 bytes
+	* reservados y luego por cada columna el byte de inicio (4 bytes), el tama&ntilde;o y la longitud de fondo
+	* (2 bytes cada uno). Al cargarlo se comprueba cada columna contra la cabecera y el tama&ntilde;o del fichero
+	* IMG, como al leerlas del propio fichero, porque los decodificadores acceden a los datos sin comprobarlos.
+	*/
+	class ColumnIndex
+	{
+	private:
+		/**
+		* Las estructuras de las columnas, en el orden en que aparecen en el fichero IMG.
+		*/
+		std::vector<ImageDataControl> columns;
+
+		/**
+		* El alto de los datos de la imagen: el mayor valor de longitud de fondo m&aacute;s tama&ntilde;o de columna.
+		*/
+		int dataHeight;
+
+	public:
+		/**
+		* Firma del fichero del &iacute;ndice de columnas.
+		*/
+		static const char signature[8];
+
+		/**
+		* Constructor de la clase. Crea un &iacute;ndice vac&iacute;o.
+		*/
+		ColumnIndex();
+
+		/**
+		* Elimina todas las columnas del &iacute;ndice.
+		*/
+		void clear(void);
+
+		/**
+		* Agrega una columna al final del &iacute;ndice.
+		* @param column La estructura de la columna.
+		*/
+		void add(const ImageDataControl &column);
+
+		/**
+		* Cantidad de columnas del &iacute;ndice.
+		*/
+		inline size_t size() const { return this->columns.size(); }
+
+		/**
+		* La estructura de una columna.
+		*/
+		inline const ImageDataControl &operator[](size_t column) const { return this->columns[column]; }
+
+		/**
+		* El alto de los datos de la imagen: el mayor valor de longitud de fondo m&aacute;s tama&ntilde;o de columna,
+		* 0 si el &iacute;ndice est&aacute; vac&iacute;o.
+		*/
+		inline int getDataHeight() const { return this->dataHeight; }
+
+		/**
+		* Guarda el &iacute;ndice en un fichero.
+		* @param path La direcci&oacute;n del fichero.
+		* @param sourceSize El tama&ntilde;o del fichero IMG indexado, se comprueba al cargar el &iacute;ndice.
+		* @param width El ancho de la cabecera del fichero IMG.
+		* @param height El alto de la cabecera del fichero IMG.
+		* @param startIndex El byte donde comienzan los datos seg&uacute;n la cabecera.
+		* @return true si el fichero fue escrito.
+		*/
+		bool save(const char *path, uint64_t sourceSize, int width, int height, long startIndex) const;
+
+		/**
+		* Carga el &iacute;ndice de un fichero creado con save().
+		* @param path La direcci&oacute;n del fichero.
+		* @param sourceSize El tama&ntilde;o del fichero IMG, el &iacute;ndice no se carga si no coincide con el guardado.
+		* @param width El ancho de la cabecera del fichero IMG; el &iacute;ndice no puede tener m&aacute;s columnas.
+		* @param height El alto de la cabecera del fichero IMG; ninguna columna puede ser m&aacute;s alta.
+		* @param startIndex El byte donde comienzan los datos seg&uacute;n la cabecera.
+		* @return true si el &iacute;ndice fue cargado; en otro caso (fichero de otra imagen o da&ntilde;ado) el
+		* &iacute;ndice no se modifica.
+		*/
+		bool load(const char *path, uint64_t sourceSize, int width, int height, long startIndex);
+	};
+}
+
+#endif // COLUMNINDEX_H
@@ -0,0 +1,270 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include <algorithm>
+#include "ColumnStreamDecoder.h"
+#include "PixelUnpacker.h"
+
+namespace img
+{
+	ColumnStreamDecoder::ColumnStreamDecoder(ColumnSink &sink) :sink(sink), hues(table), formatType(0), width(0), height(0),
+		columnCount(0), emittedCount(halo), completed(false), finished(false)
+	{
+	}
+
+	ColumnStreamDecoder::~ColumnStreamDecoder()
+	{
+	}
+
+	void ColumnStreamDecoder::push(const byte *bytes, size_t count)
+	{
+		if(finished)
+			throw invalid_argument("IMG stream already finished.");
+
+		if(completed)
+			return;
+
+		if(formatType == 0)
+		{
+			pending.insert(pending.end(), bytes, bytes + count);
+
+			if(pending.size() < (size_t)Format::headerProbeSize)
+				return;
+
+			size_t start = loadHeader();
+			size_t used = completed ? 0 : decodeColumns(&pending[start], pending.size() - start);
+			pending.erase(pending.begin(), pending.begin() + start + used);
+		}
+		else if(pending.empty())
+		{
+			//Se decodifica directamente de los bytes recibidos y s&oacute;lo se guarda la columna incompleta
+			size_t used = decodeColumns(bytes, count);
+			pending.assign(bytes + used, bytes + count);
+		}
+		else
+		{
+			pending.insert(pending.end(), bytes, bytes + count);
+
+			size_t used = decodeColumns(&pending[0], pending.size());
+			pending.erase(pending.begin(), pending.begin() + used);
+		}
+
+		if(completed)
+		{
+			vector<byte>().swap(pending);
+			emitRemaining();
+		}
+	}
+
+	void ColumnStreamDecoder::finish(void)
+	{
+		if(finished)
+			return;
+
+		//push entrega las columnas que faltan al completar la imagen; si no, se entregan aqu&iacute;
+		bool emitted = completed;
+
+		//Un fichero menor que Format::headerProbeSize llega completo aqu&iacute;: se decodifica igual que en push
+		if(formatType == 0)
+		{
+			size_t start = loadHeader();
+			if(!completed)
+				decodeColumns(pending.empty() ? NULL : &pending[0] + start, pending.size() - start);
+		}
+
+		finished = true;
+		completed = true;
+
+		if(!emitted)
+			emitRemaining();
+
+		vector<byte>().swap(pending);
+	}
+
+	size_t ColumnStreamDecoder::loadHeader(void)
+	{
+		SpanSource source(pending.empty() ? NULL : &pending[0], pending.size());
+		Format header(source);
+
+		if(header.getFormatType() == 0)
+			throw invalid_argument("Invalid IMG format.");
+
+		header.loadHeaderData();
+
+		width = header.getWidth();
+		height = header.getHeight();
+		formatType = header.getFormatType();
+
+		int slots = ringSize + headSize;
+		valuesH.assign((size_t)slots * height, 0);
+		valuesS.assign((size_t)slots * height, 1.0);
+		valuesI.assign((size_t)slots * height, 1.0);
+		zeroPaddings.assign(slots, 0);
+		columnLengths.assign(slots, 0);
+
+		background.assign(height, 1.0);
+		filtered.resize(height);
+		outR.resize(height);
+		outG.resize(height);
+		outB.resize(height);
+
+		if(width <= 0)
+			completed = true;
+
+		size_t start = (size_t)header.getStartIndex() - 1;
+		return start < pending.size() ? start : pending.size();
+	}
+
+	size_t ColumnStreamDecoder::decodeColumns(const byte *bytes, size_t count)
+	{
+		size_t used = 0;
+		ByteReader reader(bytes, count);
+
+		while(!completed && reader.covers(used, 8))
+		{
+			int columnLength = reader.read16(used);
+			int zeroPadding = reader.read16(used + 2);
+
+			if(columnLength + zeroPadding > height)
+			{
+				completed = true;
+				break;
+			}
+
+			size_t recordSize = 8 + (size_t)columnLength * 4; //2 bytes de CL + 2 bytes de ZP + 4 bytes de ZM + 4 bytes por pixel
+			if(!reader.covers(used, recordSize))
+				break;
+
+			int column = columnCount;
+			int slot = column % ringSize;
+			byte *columnH = &valuesH[(size_t)slot * height];
+			double *columnS = &valuesS[(size_t)slot * height];
+			double *columnI = &valuesI[(size_t)slot * height];
+
+			std::fill(columnH, columnH + height, 0);
+			std::fill(columnS, columnS + height, 1.0);
+			std::fill(columnI, columnI + height, 1.0);
+
+			//Del mat&iacute;z s&oacute;lo se guarda bch3
+			const byte *pixels = reader.at(used + 8);
+			PixelUnpacker::decode(pixels, columnLength, table, NULL, columnS + zeroPadding, columnI + zeroPadding);
+			for(int k = 0; k < columnLength; k++)
+				columnH[zeroPadding + k] = pixels[k * 4 + 3];
+
+			zeroPaddings[slot] = zeroPadding;
+			columnLengths[slot] = columnLength;
+
+			if(column < headSize)
+			{
+				int head = ringSize + column;
+				std::copy(columnH, columnH + height, valuesH.begin() + (size_t)head * height);
+				std::copy(columnS, columnS + height, valuesS.begin() + (size_t)head * height);
+				std::copy(columnI, columnI + height, valuesI.begin() + (size_t)head * height);
+				zeroPaddings[head] = zeroPadding;
+				columnLengths[head] = columnLength;
+			}
+
+			used += recordSize;
+			columnCount++;
+
+			//La columna que est&aacute; halo posiciones atr&aacute;s ya tiene todas sus vecinas
+			if(column - halo >= halo)
+			{
+				emit(column - halo);
+				emittedCount = column - halo + 1;
+			}
+
+			if(columnCount == width)
+				completed = true;
+		}
+
+		return used;
+	}
+
+	int ColumnStreamDecoder::slotOf(int column) const
+	{
+		if(column >= columnCount)
+			return -1;
+
+		if(column < headSize)
+			return ringSize + column;
+
+		return column % ringSize;
+	}
+
+	const double *ColumnStreamDecoder::intensityOf(int column) const
+	{
+		int slot = slotOf(column);
+
+		return slot < 0 ? &background[0] : &valuesI[(size_t)slot * height];
+	}
+
+	void ColumnStreamDecoder::emit(int column)
+	{
+		std::fill(outR.begin(), outR.end(), 255.0);
+		std::fill(outG.begin(), outG.end(), 255.0);
+		std::fill(outB.begin(), outB.end(), 255.0);
+
+		int slot = slotOf(column);
+		if(slot >= 0)
+		{
+			const double *neighbours[Format::filterHeight];
+			for(int filterY = 0; filterY < Format::filterHeight; filterY++)
+				neighbours[filterY] = intensityOf((column - Format::filterHeight / 2 + filterY + width) % width);
+
+			const byte *columnH = &valuesH[(size_t)slot * height];
+			const double *columnS = &valuesS[(size_t)slot * height];
+
+			int zeroPadding = zeroPaddings[slot];
+			int columnLength = columnLengths[slot];
+
+			for(int x = zeroPadding; x < columnLength + zeroPadding; x++)
+			{
+				double value = 0.0;
+
+				//Mismo orden de suma que Format::imgFilter2D para obtener el mismo resultado
+				for(int filterX = 0; filterX < Format::filterWidth; filterX++)
+				{
+					int imageX = (x - Format::filterWidth / 2 + filterX + height) % height;
+
+					for(int filterY = 0; filterY < Format::filterHeight; filterY++)
+						value += neighbours[filterY][imageX] * Format::filter[filterX][filterY];
+				}
+
+				filtered[x] = value > 1 ? 1 : value;
+			}
+
+			hues.convertRow(columnH + zeroPadding, columnS + zeroPadding, &filtered[zeroPadding], columnLength,
+				&outR[zeroPadding], &outG[zeroPadding], &outB[zeroPadding]);
+		}
+
+		sink.onColumn(column, &outR[0], &outG[0], &outB[0], height);
+	}
+
+	void ColumnStreamDecoder::emitRemaining(void)
+	{
+		if(height <= 0)
+			return;
+
+		for(int column = emittedCount; column < width; column++)
+			emit(column);
+
+		for(int column = 0; column < halo && column < width; column++)
+			emit(column);
+
+		emittedCount = width;
+	}
+}
@@ -0,0 +1,253 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef COLUMNSTREAMDECODER_H
+#define COLUMNSTREAMDECODER_H
+
+#include <stddef.h>
+#include <vector>
+#include "Format.h"
+#include "HSIColorTable.h"
+#include "HueTable.h"
+
+typedef unsigned char byte;
+
+namespace img
+{
+	/**
+	* Receptor de las columnas decodificadas por ColumnStreamDecoder.
+	*/
+	class ColumnSink
+	{
+	public:
+		/**
+		* Destructor de la clase.
+		*/
+		virtual ~ColumnSink() {}
+
+		/**
+		* Recibe una columna de la imagen ya decodificada y convertida a RGB. Los arreglos s&oacute;lo son
+		* v&aacute;lidos durante la llamada.
+		* @param column El n&uacute;mero de la columna en la imagen.
+		* @param r Los valores del canal de Rojo de la columna, uno por fila.
+		* @param g Los valores del canal de Verde de la columna, uno por fila.
+		* @param b Los valores del canal de Azul de la columna, uno por fila.
+		* @param height La cantidad de filas de la columna.
+		*/
+		virtual void onColumn(int column, const double *r, const double *g, const double *b, int height) = 0;
+	};
+
+	/**
+	* Decodificador incremental del formato IMG. Recibe los bytes del fichero por partes, a medida que el
+	* equipo de Rayos X los produce, y entrega cada columna en RGB tan pronto como est&aacute;n disponibles
+	* las columnas vecinas que necesita el filtro de realce de bordes. La memoria utilizada depende s&oacute;lo
+	* del alto de la imagen y no de la cantidad de columnas.
+	*
+	* Las columnas se entregan en orden a partir de la columna 3. Las columnas 0, 1 y 2 dependen, por el borde
+	* circular del filtro, de las &uacute;ltimas columnas de la imagen y se entregan al llamar finish(void).
+	* El borde circular vertical del filtro se calcula con el alto de la cabecera; la decodificaci&oacute;n completa
+	* de Format utiliza el alto de la columna m&aacute;s alta, por lo que las filas extremas pueden diferir
+	* cuando ninguna columna llega hasta el alto de la cabecera.
+	*/
+	class ColumnStreamDecoder
+	{
+	private:
+		/**
+		* Cantidad de columnas vecinas a cada lado que necesita el filtro de realce de bordes.
+		*/
+		static const int halo = Format::filterHeight / 2;
+
+		/**
+		* Cantidad de columnas que se guardan en el buffer circular.
+		*/
+		static const int ringSize = 2 * halo + 1;
+
+		/**
+		* Cantidad de columnas del inicio de la imagen que se guardan para el borde circular del filtro.
+		*/
+		static const int headSize = 2 * halo;
+
+		/**
+		* El receptor de las columnas decodificadas.
+		*/
+		ColumnSink &sink;
+
+		/**
+		* La tabla de colores HSI.
+		*/
+		HSIColorTable table;
+
+		/**
+		* El sector y la raz&oacute;n de cada valor de mat&iacute;z de la tabla de colores.
+		*/
+		HueTable hues;
+
+		/**
+		* Bytes recibidos que a&uacute;n no se han procesado: la cabecera o una columna incompleta.
+		*/
+		std::vector<byte> pending;
+
+		/**
+		* Identificador del tipo de formato, 0 mientras no se ha le&iacute;do la cabecera.
+		*/
+		byte formatType;
+
+		/**
+		* El ancho de la imagen.
+		*/
+		int width;
+
+		/**
+		* El alto de la imagen.
+		*/
+		int height;
+
+		/**
+		* Cantidad de columnas decodificadas.
+		*/
+		int columnCount;
+
+		/**
+		* Cantidad de columnas entregadas al receptor en orden.
+		*/
+		int emittedCount;
+
+		/**
+		* Indica que no se aceptan m&aacute;s columnas, porque se lleg&oacute; al ancho de la imagen o
+		* porque una columna no es consistente con el alto.
+		*/
+		bool completed;
+
+		/**
+		* Indica que se llam&oacute; finish(void).
+		*/
+		bool finished;
+
+		/**
+		* Valores HSI de las columnas guardadas, height valores por columna. Las primeras ringSize posiciones son
+		* el buffer circular con las &uacute;ltimas columnas decodificadas y las siguientes headSize posiciones
+		* son las primeras columnas de la imagen. El mat&iacute;z se guarda como el valor de bch3 de cada pixel.
+		*/
+		std::vector<byte> valuesH;
+		std::vector<double> valuesS, valuesI;
+
+		/**
+		* Longitud de fondo y tama&ntilde;o de las columnas guardadas, en las mismas posiciones que los valores HSI.
+		*/
+		std::vector<int> zeroPaddings, columnLengths;
+
+		/**
+		* Una columna de fondo, con todos los valores en 1.
+		*/
+		std::vector<double> background;
+
+		/**
+		* La intensidad filtrada de la columna que se entrega.
+		*/
+		std::vector<double> filtered;
+
+		/**
+		* Los valores RGB de la columna que se entrega.
+		*/
+		std::vector<double> outR, outG, outB;
+
+	public:
+		/**
+		* Constructor de la clase.
+		* @param sink El receptor de las columnas decodificadas.
+		*/
+		ColumnStreamDecoder(ColumnSink &sink);
+
+		/**
+		* Destructor de la clase.
+		*/
+		~ColumnStreamDecoder();
+
+		/**
+		* Procesa una parte de los bytes del fichero IMG. Las columnas que quedan listas se entregan al
+		* receptor antes de retornar.
+		* @param bytes Los bytes recibidos.
+		* @param count La cantidad de bytes recibidos.
+		*/
+		void push(const byte *bytes, size_t count);
+
+		/**
+		* Indica que no se recibir&aacute;n m&aacute;s bytes y entrega las columnas pendientes. Las columnas que
+		* no llegaron a recibirse se entregan como fondo y una columna incompleta al final se descarta.
+		*/
+		void finish(void);
+
+		/**
+		* Identificador del tipo de formato del archivo IMG, 0 mientras no se ha le&iacute;do la cabecera.
+		*/
+		inline byte getFormatType() const { return this->formatType; }
+
+		/**
+		* El ancho de la imagen.
+		*/
+		inline int getWidth() const { return this->width; }
+
+		/**
+		* El alto de la imagen.
+		*/
+		inline int getHeight() const { return this->height; }
+
+		/**
+		* Cantidad de columnas decodificadas hasta el momento.
+		*/
+		inline int getColumnCount() const { return this->columnCount; }
+
+	private:
+		ColumnStreamDecoder(const ColumnStreamDecoder &);
+		ColumnStreamDecoder &operator=(const ColumnStreamDecoder &);
+
+		/**
+		* Lee la cabecera a partir de los bytes acumulados.
+		* @return La posici&oacute;n en los bytes acumulados donde comienzan los datos de la imagen.
+		*/
+		size_t loadHeader(void);
+
+		/**
+		* Decodifica todas las columnas completas que hay en los bytes dados.
+		* @param bytes Los bytes a partir del inicio de una columna.
+		* @param count La cantidad de bytes.
+		* @return La cantidad de bytes procesados.
+		*/
+		size_t decodeColumns(const byte *bytes, size_t count);
+
+		/**
+		* Posici&oacute;n de una columna en los buffers, o -1 si la columna es fondo.
+		*/
+		int slotOf(int column) const;
+
+		/**
+		* Valores de intensidad de una columna, la columna de fondo si no ha sido decodificada.
+		*/
+		const double *intensityOf(int column) const;
+
+		/**
+		* Filtra y convierte a RGB una columna y la entrega al receptor.
+		*/
+		void emit(int column);
+
+		/**
+		* Entrega todas las columnas que a&uacute;n no se han entregado, una vez que no se aceptan m&aacute;s columnas.
+		*/
+		void emitRemaining(void);
+	};
+}
+
+#endif // COLUMNSTREAMDECODER_H
@@ -0,0 +1,154 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include <algorithm>
+#include "Decoder.h"
+#include "PixelUnpacker.h"
+
+namespace img
+{
+	/**
+	* Cambia el tama&ntilde;o de una matriz guardada fila por fila sin liberar la memoria que ya tiene.
+	* @param values Los valores de la matriz.
+	* @param rows Los punteros al inicio de cada fila.
+	* @param width El ancho de la matriz.
+	* @param height El alto de la matriz.
+	* @return El arreglo bidimensional de la matriz. Los valores no se inicializan.
+	*/
+	template<typename T>
+	static T **resizePlane(std::vector<T> &values, std::vector<T*> &rows, int width, int height)
+	{
+		values.resize((size_t)width * height);
+		rows.resize(height);
+
+		for(int k = 0; k < height; k++)
+			rows[k] = &values[(size_t)k * width];
+
+		return &rows[0];
+	}
+
+	Decoder::Decoder(HSIColorTable::Precision precision)
+		:precision(precision), filtered(true)
+	{
+	}
+
+	void Decoder::decodeColors(const Format &format, const ColumnIndex &index, const Calibration &calibration, RGBImage &image)
+	{
+		int columns;
+		const byte *colors = calibration.getColorValues(columns);
+		int lastColumn = columns - 1;
+
+		double **array2dR = image.getChannelR();
+		double **array2dG = image.getChannelG();
+		double **array2dB = image.getChannelB();
+
+		int idcsSize = (int)index.size();
+
+		for(int k = 0; k < idcsSize; k++)
+		{
+			int zeroPadding = index[k].getZeroPadding();
+			int columnLength = index[k].getColumnLength();
+			const byte *pixels = format.data + index[k].getStartByte() + 7;
+
+			for(int i = 0; i < columnLength; i++, pixels += 4)
+			{
+				int indexI = (pixels[1] << 3) + (pixels[0] >> 5);
+				int bch3 = pixels[3] < lastColumn ? pixels[3] : lastColumn;
+				const byte *entry = colors + ((size_t)indexI * columns + bch3) * 4;
+
+				array2dR[zeroPadding + i][k] = entry[2];
+				array2dG[zeroPadding + i][k] = entry[1];
+				array2dB[zeroPadding + i][k] = entry[0];
+			}
+		}
+	}
+
+	void Decoder::decode(Format &format, RGBImage &image)
+	{
+		if(format.formatType == 0)
+			throw invalid_argument("Invalid IMG format.");
+
+		if(format.startIndex == 0)
+			throw invalid_argument("IMG header couldn't be opened.");
+
+		const ColumnIndex *index = &format.columnIndex;
+		if(index->size() == 0)
+		{
+			format.scanColumns(columns);
+			index = &columns;
+		}
+
+		format.requestColumns(*index);
+
+		HSIColorTable table = format.getColorTable(precision);
+		hues.build(table);
+
+		int width = format.width;
+		int height = index->getDataHeight() == 0 ? format.height : index->getDataHeight();
+		format.height = height;
+
+		image.resize(width, height);
+		image.fill(255);
+
+		if(width == 0 || height == 0)
+			return;
+
+		if(!filtered)
+		{
+			decodeColors(format, *index, table.getCalibration(), image);
+			return;
+		}
+
+		//S&oacute;lo la intensidad necesita valor de fondo: el filtro la lee en los bordes de las columnas
+		byte **array2dH = resizePlane(valuesH, rowsH, width, height);
+		double **array2dS = resizePlane(valuesS, rowsS, width, height);
+		double **array2dI = resizePlane(valuesI, rowsI, width, height);
+		double **resultI = resizePlane(valuesFiltered, rowsFiltered, width, height);
+
+		for(int k = 0; k < height; k++)
+			std::fill(array2dI[k], array2dI[k] + width, 1.0);
+
+		if(columnS.size() < (size_t)height)
+		{
+			columnS.resize(height);
+			columnI.resize(height);
+		}
+
+		int idcsSize = (int)index->size();
+
+		for(int k = 0; k < idcsSize; k++)
+		{
+			int zeroPadding = (*index)[k].getZeroPadding();
+			int columnLength = (*index)[k].getColumnLength();
+			if(columnLength == 0)
+				continue;
+
+			const byte *pixels = format.data + (*index)[k].getStartByte() + 7;
+			PixelUnpacker::decode(pixels, columnLength, table, NULL, &columnS[0], &columnI[0]);
+
+			for(int i = 0; i < columnLength; i++)
+			{
+				array2dH[zeroPadding + i][k] = pixels[i * 4 + 3];
+				array2dS[zeroPadding + i][k] = columnS[i];
+				array2dI[zeroPadding + i][k] = columnI[i];
+			}
+		}
+
+		Format::imgFilter2D(array2dI, resultI, width, height, *index);
+
+		Format::convertRows(hues, array2dH, array2dS, resultI, width, *index, 0, height, image.getChannelR(), image.getChannelG(), image.getChannelB());
+	}
+}
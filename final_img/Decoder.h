@@ -0,0 +1,135 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <vector>
+#include "ColumnIndex.h"
+#include "Format.h"
+#include "HSIColorTable.h"
+#include "HueTable.h"
+#include "RGBImage.h"
+
+namespace img
+{
+	/**
+	* Decodificador reutilizable para muchos ficheros IMG. La tabla de colores se elige seg&uacute;n el modelo de
+	* cada fichero sin copiar sus valores y las matrices de trabajo s&oacute;lo crecen, por lo que luego de
+	* decodificar la imagen m&aacute;s grande del lote no se reserva m&aacute;s memoria. El resultado es el mismo que el de Format::loadImageData(int).
+	*
+	* Un Decoder no debe usarse desde varios hilos a la vez; para decodificar en paralelo se usa un
+	* Decoder por hilo.
+	*
+	* Ejemplo de uso:
+	* <pre>
+	* Decoder decoder;
+	* RGBImage image;
+	* for(...)
+	* {
+	*     MappedSource source(path);
+	*     Format format(source);
+	*     format.loadHeaderData();
+	*     decoder.decode(format, image);
+	*     ...
+	* }
+	* </pre>
+	*/
+	class Decoder
+	{
+	private:
+		/**
+		* La precisi&oacute;n de la tabla de colores.
+		*/
+		HSIColorTable::Precision precision;
+
+		/**
+		* Indica si se aplica el filtro de realce de bordes a la intensidad.
+		*/
+		bool filtered;
+
+		/**
+		* El &iacute;ndice de columnas, si el objeto Format no tiene uno.
+		*/
+		ColumnIndex columns;
+
+		/**
+		* El sector y la raz&oacute;n de cada valor de mat&iacute;z, para la tabla de colores del &uacute;ltimo fichero.
+		*/
+		HueTable hues;
+
+		/**
+		* Los valores de las matrices HSI y de la intensidad filtrada, fila por fila. El mat&iacute;z se guarda como
+		* el valor de bch3 de cada pixel.
+		*/
+		std::vector<byte> valuesH;
+		std::vector<double> valuesS, valuesI, valuesFiltered;
+
+		/**
+		* Punteros al inicio de cada fila de las matrices.
+		*/
+		std::vector<byte*> rowsH;
+		std::vector<double*> rowsS, rowsI, rowsFiltered;
+
+		/**
+		* Los valores de saturaci&oacute;n e intensidad de la columna que se decodifica; del mat&iacute;z s&oacute;lo se
+		* guarda bch3.
+		*/
+		std::vector<double> columnS, columnI;
+
+		/**
+		* Decodifica la imagen sin el filtro, con una lectura de la tabla de colores por pixel.
+		*/
+		void decodeColors(const Format &format, const ColumnIndex &index, const Calibration &calibration, RGBImage &image);
+
+		Decoder(const Decoder &);
+		Decoder &operator=(const Decoder &);
+
+	public:
+		/**
+		* Constructor de la clase.
+		* @param precision La precisi&oacute;n de la tabla de colores.
+		* @see HSIColorTable
+		*/
+		Decoder(HSIColorTable::Precision precision = HSIColorTable::doublePrecision);
+
+		/**
+		* Activa o desactiva el filtro de realce de bordes, activado por defecto. Sin el filtro el color de un
+		* pixel depende s&oacute;lo de sus bytes, por lo que cada pixel se decodifica con una lectura de la tabla de
+		* colores de la calibraci&oacute;n (Calibration::getColorValues), directamente en la imagen y sin matrices
+		* HSI. Los valores RGB son los de la conversi&oacute;n sin filtro truncados a enteros, por lo que al pasar la
+		* imagen a 8 bits cada pixel tiene el mismo color que si se calculara en double.
+		* @param filtered true para aplicar el filtro.
+		*/
+		inline void setFiltered(bool filtered) { this->filtered = filtered; }
+
+		/**
+		* Indica si se aplica el filtro de realce de bordes.
+		*/
+		inline bool isFiltered(void) const { return this->filtered; }
+
+		/**
+		* Decodifica la imagen de un fichero IMG. Si el objeto Format no tiene &iacute;ndice de columnas se construye
+		* uno propio del decodificador. Como en Format::loadImageData(int), el alto de format pasa a ser el alto
+		* de los datos de la imagen.
+		* @param format El fichero IMG, luego de llamar Format::loadHeaderData(void).
+		* @param image La imagen donde se escribe el resultado.
+		*/
+		void decode(Format &format, RGBImage &image);
+	};
+}
+
+#endif // DECODER_H
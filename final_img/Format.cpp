@@ -14,34 +14,71 @@
 * Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
 */
 
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+#include <thread>
 #include "Format.h"
+#include "HueTable.h"
+#include "PixelUnpacker.h"
 
 namespace img
 {
-	Format::Format(const char *fullImageName) :startIndex(0), width(0), height(0) {
+	Format::Format(const char *fullImageName) :startIndex(0), width(0), height(0), headerHeight(0), headerStartIndex(0), array2dR(NULL), array2dG(NULL), array2dB(NULL), source(NULL), ownsSource(true) {
 
-		byteArray = file2ByteVector(fullImageName);
+		MappedSource *mapped = new MappedSource(fullImageName);
+
+		if(mapped->isOpen())
+			source = mapped;
+		else
+		{
+			delete mapped;
+
+			vector<byte> bytes = file2ByteVector(fullImageName);
+			source = new BufferSource(bytes);
+		}
+
+		data = source->getData();
+		dataSize = source->getSize();
+		whatFormat();
+	}
+
+	Format::Format(ByteSource &source) :startIndex(0), width(0), height(0), headerHeight(0), headerStartIndex(0), array2dR(NULL), array2dG(NULL), array2dB(NULL), source(&source), ownsSource(false) {
+
+		data = source.getData();
+		dataSize = source.getSize();
 		whatFormat();
 	}
 
 	Format::~Format(void)
 	{
-		for(int k = 0; k < height; k++)
-		{	
-			delete[] array2dB[k];
-			delete[] array2dG[k];
-			delete[] array2dR[k];
+		if(array2dR != NULL)
+		{
+			for(int k = 0; k < height; k++)
+			{	
+				delete[] array2dB[k];
+				delete[] array2dG[k];
+				delete[] array2dR[k];
+			}
+
+			delete[] array2dB;
+			delete[] array2dG;
+			delete[] array2dR;
 		}
 
-		/*delete[] array2dB;
-		delete[] array2dG;
-		delete[] array2dR;*/
+		if(ownsSource)
+			delete source;
 	}
 
 	void Format::whatFormat()
 	{
 		int const count = 8;
-		string id = getString(1, count + 1);
+
+		byte header[headerProbeSize];
+		copyHeader(header);
+		ByteReader reader(header, headerProbeSize);
+
+		string id = reader.readString(0, count);
 		formatType = -1;	
 		short firma[count] = {0, 0, 44, 0, 0, 0, -81, 0};
 
@@ -55,151 +92,289 @@ namespace img
 			}
 		}	
 
-		formatType = !valid == 0 ? (byte)this->read1Byte(23) > 100 ? 1 : 2 : 0;	
+		if(!valid)
+			formatType = 0;
+		else if(FormatLayout1::matches(reader))
+			formatType = FormatLayout1::formatType;
+		else if(FormatLayout2::matches(reader))
+			formatType = FormatLayout2::formatType;
+		else
+			formatType = 0;
+	}
+
+	bool Format::available(size_t end)
+	{
+		if(end <= dataSize)
+			return true;
+
+		bool result = source->request(end);
+		data = source->getData();
+		dataSize = source->getSize();
+
+		return result;
+	}
+
+	void Format::copyHeader(byte *header)
+	{
+		available(headerProbeSize);
+
+		size_t count = dataSize < headerProbeSize ? dataSize : headerProbeSize;
+		if(count > 0)
+			memcpy(header, data, count);
+
+		memset(header + count, 0, headerProbeSize - count);
+	}
+
+	template<typename Layout>
+	ValidationReport::Status Format::readColumnRecord(size_t position, int &columnLength, int &zeroPadding)
+	{
+		//2 bytes de CL + 2 bytes de ZP + 4 bytes de ZM = 8 bytes
+		if(!available(position + Layout::columnHeaderSize))
+			return available(position + 1) ? ValidationReport::truncatedColumn : ValidationReport::missingColumns;
+
+		ByteReader reader(data, dataSize);
+		columnLength = reader.read16(position + Layout::columnLengthOffset);
+		zeroPadding = reader.read16(position + Layout::zeroPaddingOffset);
+
+		if(columnLength + zeroPadding > height)
+			return ValidationReport::columnTooTall;
+
+		//Los pixeles de la columna se comprueban juntos, 4 bytes por pixel
+		if(!available(position + Layout::columnHeaderSize + (size_t)columnLength * Layout::pixelSize))
+			return ValidationReport::truncatedColumn;
+
+		return ValidationReport::valid;
+	}
+
+	const byte *Format::columnPixels(const ImageDataControl &idc)
+	{
+		size_t position = idc.getStartByte() - 1;
+
+		if(!available(position + 8 + (size_t)idc.getColumnLength() * 4))
+			throw invalid_argument("Invalid IMG column index.");
+
+		return data + position + 8;
+	}
+
+	void Format::requestColumns(const ColumnIndex &index)
+	{
+		size_t end = 0;
+		for(size_t k = 0; k < index.size(); k++)
+			end = std::max(end, (size_t)index[k].getStartByte() + 7 + (size_t)index[k].getColumnLength() * 4);
+
+		if(!available(end))
+			throw invalid_argument("Invalid IMG column index.");
 	}
 
 	vector<byte> Format::file2ByteVector(const char *dir){
 
 		ifstream file(dir, ios::binary);
+		if(!file)
+			return vector<byte>();
+
 		file.seekg(0, ios::end);
 		size_t fileSize = file.tellg();
 		file.seekg(0, ios::beg);
 
-		vector<byte> data(fileSize, 0);
-		file.read(reinterpret_cast<char*>(&data[0]), fileSize);
+		vector<byte> bytes(fileSize, 0);
+		if(fileSize > 0)
+			file.read(reinterpret_cast<char*>(&bytes[0]), fileSize);
 
 		file.close();
 
-		return data;
+		return bytes;
 	}
 
 	void Format::loadHeaderData()
 	{
+		byte header[headerProbeSize];
+		copyHeader(header);
+		ByteReader reader(header, headerProbeSize);
+
 		switch(formatType)
 		{
-		case 1:
-			{
-				width = (int)this->read2Bytes(649);
-				height = (int)this->read2Bytes(651);
-				sequenceNumber = this->read4Bytes(661);
-				model = this->getString(333, 344);
-				date = this->getString(349, 368);
-				systemId = this->getString(383, 393);
-				dataBytes = this->read4Bytes(641);
-				imageBytes = this->read4Bytes(657);
-				rayIntensity = this->read2Bytes(799) / 10.0;
-				startIndex = 825;
-			}
+		case FormatLayout1::formatType:
+			loadHeaderFields<FormatLayout1>(reader);
 			break;
-		case 2:
-			{
-				width = (int)this->read2Bytes(69);
-				height = (int)this->read2Bytes(71);
-				sequenceNumber = 0.0;
-				model = this->getString(43, 51);
-				date = this->getString(58, 78);
-				systemId = this->getString(383, 393);
-				dataBytes = this->read4Bytes(61);
-				imageBytes = this->read4Bytes(77);
-
-				startIndex = 245;
-			}
+		case FormatLayout2::formatType:
+			loadHeaderFields<FormatLayout2>(reader);
 			break;
 		default:
 			throw invalid_argument("Invalid IMG format.");
 		}
 	}
 
-	void Format::loadImageData(){
+	template<typename Layout>
+	void Format::loadHeaderFields(const ByteReader &header)
+	{
+		width = header.read16(Layout::widthOffset);
+		height = header.read16(Layout::heightOffset);
+		sequenceNumber = Layout::hasSequenceNumber ? header.read32(Layout::sequenceNumberOffset) : 0.0;
+		model = header.readString(Layout::modelOffset, Layout::modelLength);
+		date = header.readString(Layout::dateOffset, Layout::dateLength);
+		systemId = header.readString(Layout::systemIdOffset, Layout::systemIdLength);
+		dataBytes = header.read32(Layout::dataBytesOffset);
+		imageBytes = header.read32(Layout::imageBytesOffset);
+		rayIntensity = Layout::hasRayIntensity ? header.read16(Layout::rayIntensityOffset) / 10.0 : 0.0;
+		startIndex = Layout::startIndex;
+		headerHeight = height;
+		headerStartIndex = startIndex;
+	}
 
-		try
-		{
-			if(formatType == 0)
-				throw invalid_argument("Invalid IMG format.");
+	ImageHeader Format::getHeader() const
+	{
+		ImageHeader header;
+
+		header.formatType = formatType;
+		header.model = model;
+		header.date = date;
+		header.systemId = systemId;
+		header.sequenceNumber = sequenceNumber;
+		header.width = width;
+		header.height = height;
+		header.rayIntensity = rayIntensity;
+
+		return header;
+	}
 
-			if(startIndex == 0)			
-				throw invalid_argument("IMG header couldn't be opened.");			
+	bool Format::probeHeader(const char *fullImageName, ImageHeader &header)
+	{
+		FILE *file = fopen(fullImageName, "rb");
+		if(file == NULL)
+			return false;
 
-			vector<byte> channel0;
-			vector<byte> channel1;
-			vector<byte> channel2;
-			vector<byte> channel3;     	
+		//Sin buffer intermedio: se hace una sola lectura de headerProbeSize bytes
+		setvbuf(file, NULL, _IONBF, 0);
 
-			vector<double> channelH;	
-			vector<double> channelS;
-			vector<double> channelI;
+		byte bytes[headerProbeSize];
+		size_t count = fread(bytes, 1, headerProbeSize, file);
+		fclose(file);
 
-			vector<ImageDataControl> idcs;
-			HSIColorTable table;
+		SpanSource source(bytes, count);
+		Format format(source);
 
-			int columnActual = 0;
-			int dataHeight = 0;	
+		if(format.getFormatType() == 0)
+			return false;
 
-			while (startIndex < byteArray.size() && columnActual < width)
-			{	
-				int columnLength = (int)read2Bytes(startIndex);
-				int zeroPadding = (int)read2Bytes(startIndex + 2);
+		format.loadHeaderData();
+		header = format.getHeader();
 
-				if(startIndex + columnLength > byteArray.size())
-					break;
+		return true;
+	}
 
-				if(columnLength + zeroPadding > height)
-					break;
+	/**
+	* Divide las columnas del &iacute;ndice en bloques contiguos con aproximadamente la misma cantidad de pixeles.
+	* @param columnIndex El &iacute;ndice de columnas.
+	* @param parts La cantidad de bloques.
+	* @return Los l&iacute;mites de los bloques: el bloque t va desde la columna bounds[t] hasta bounds[t + 1].
+	*/
+	static vector<int> splitColumns(const ColumnIndex &columnIndex, int parts)
+	{
+		int count = (int)columnIndex.size();
 
-				ImageDataControl idc(startIndex, columnLength, zeroPadding);
-				idcs.push_back(idc);
+		size_t total = 0;
+		for(int k = 0; k < count; k++)
+			total += columnIndex[k].getColumnLength();
 
-				startIndex += 8; //2 bytes de CL + 2 bytes de ZP + 4 bytes de ZM = 8 bytes
+		vector<int> bounds(parts + 1, count);
+		bounds[0] = 0;
 
-				if (columnLength != 0)
-				{
-					int channelValues = 0;
-					for (int i = 0; i < columnLength; i++)
-					{
-						long posAux = startIndex + channelValues;
+		//Suma acumulada de pixeles: el bloque t comienza donde se alcanzan t * total / parts pixeles
+		size_t pixels = 0;
+		int part = 1;
+		for(int k = 0; k < count && part < parts; k++)
+		{
+			while(part < parts && pixels >= total * part / parts)
+				bounds[part++] = k;
 
-						byte bch0 = read1Byte(posAux);
-						byte bch1 = read1Byte(posAux + 1);
-						byte bch2 = read1Byte(posAux + 2);
-						byte bch3 = read1Byte(posAux + 3);
+			pixels += columnIndex[k].getColumnLength();
+		}
 
-						channel0.push_back(bch0);
-						channel1.push_back(bch1);
-						channel2.push_back(bch2);
-						channel3.push_back(bch3);
+		return bounds;
+	}
 
-						int ch1I = bch1 << 3;
-						int ch0I = bch0 >> 5;
+	/**
+	* Divide las filas de la imagen en bloques de igual tama&ntilde;o.
+	* @param height El alto de la imagen.
+	* @param parts Cantidad de bloques.
+	* @return Los l&iacute;mites de los bloques: el bloque t son las filas desde bounds[t] hasta bounds[t + 1].
+	*/
+	static vector<int> splitRows(int height, int parts)
+	{
+		vector<int> bounds(parts + 1);
 
-						int indexI = ch1I + ch0I;				
-						double valueI = table.iCurve[indexI];
-						channelI.push_back(valueI); 
+		for(int t = 0; t <= parts; t++)
+			bounds[t] = (int)((long long)height * t / parts);
 
-						channelH.push_back(table.hCurve[bch3]);
+		return bounds;
+	}
 
-						int bch3Control = 32;
-						bch3 = bch3 > bch3Control ? bch3Control : bch3;
+	/**
+	* Ejecuta body(first, last) para cada bloque de columnas o de filas, un bloque por hilo. Si un hilo no
+	* puede crearse su bloque se ejecuta en el hilo que llama.
+	*/
+	template<typename Body>
+	static void forEachBlock(const vector<int> &bounds, Body body)
+	{
+		vector<std::thread> workers;
 
-						int indexS = (indexI) * (bch3Control + 1)  + bch3;
-						double valueS = table.sMatrix[indexS];
-						channelS.push_back(valueS);
+		for(size_t t = 1; t + 1 < bounds.size(); t++)
+		{
+			try
+			{
+				workers.push_back(std::thread(body, bounds[t], bounds[t + 1]));
+			}
+			catch(...)
+			{
+				body(bounds[t], bounds[t + 1]);
+			}
+		}
 
-						channelValues += 4;
-					}
-				}
+		body(bounds[0], bounds[1]);
 
-				startIndex += columnLength * 4; //each CL's column contains 4 bytes
+		for(size_t t = 0; t < workers.size(); t++)
+			workers[t].join();
+	}
 
-				if (dataHeight < columnLength + zeroPadding)
-					dataHeight = columnLength + zeroPadding;
+	void Format::loadImageData(int threads){
 
-				columnActual++;
+		try
+		{
+			if(formatType == 0)
+				throw invalid_argument("Invalid IMG format.");
+
+			if(startIndex == 0)			
+				throw invalid_argument("IMG header couldn't be opened.");			
+
+			HSIColorTable table = getColorTable();
+			HueTable hues(table);
+
+			//Primera pasada: s&oacute;lo las estructuras de las columnas, para conocer el alto de los datos
+			if(columnIndex.size() == 0)
+				buildColumnIndex();
+
+			int idcsSize = columnIndex.size();
+
+			if(idcsSize > 0)
+			{
+				const ImageDataControl &last = columnIndex[idcsSize - 1];
+				startIndex = last.getStartByte() + 8 + last.getColumnLength() * 4;
 			}
 
+			//Los bytes de todas las columnas se piden antes de repartirlas entre los hilos
+			requestColumns(columnIndex);
+
+			if(threads <= 0)
+				threads = std::thread::hardware_concurrency() == 0 ? 1 : (int)std::thread::hardware_concurrency();
+
+			vector<int> blocks = splitColumns(columnIndex, threads < idcsSize ? threads : (idcsSize > 0 ? idcsSize : 1));
+
 			//Inicializo los valores de los arrays HSI
+			int dataHeight = columnIndex.getDataHeight();
 			height = dataHeight == 0 ? height : dataHeight;
 
-			double **array2dH = new double*[height];
+			//El mat&iacute;z se guarda como el valor de bch3 de cada pixel, el &iacute;ndice de la tabla de mat&iacute;z
+			byte **array2dH = new byte*[height];
 			double **array2dS = new double*[height];
 			double **array2dI = new double*[height];
 			double **resultI = new double*[height];
@@ -210,7 +385,7 @@ namespace img
 
 			for(int k = 0; k < height; k++)
 			{
-				array2dH[k] = new double[width];
+				array2dH[k] = new byte[width];
 				array2dS[k] = new double[width];
 				array2dI[k] = new double[width];
 				resultI[k] = new double[width];
@@ -219,58 +394,52 @@ namespace img
 				array2dG[k] = new double[width];
 				array2dB[k] = new double[width];
 
-				for(int j = 0; j < width; j++) 
-				{	
-					array2dH[k][j] = 1;		
-					array2dS[k][j] = 1;
-					array2dI[k][j] = 1;
-					resultI[k][j] = 1;
-
-					array2dR[k][j] = 255;
-					array2dG[k][j] = 255;
-					array2dB[k][j] = 255;
-				}
-			}	
+				//S&oacute;lo se inicializa lo que se lee fuera de las columnas: la intensidad de fondo, que usa el
+				//filtro en los bordes de las columnas, y el color de fondo. H, S y la intensidad filtrada s&oacute;lo
+				//se leen dentro de las columnas, donde siempre se escriben.
+				std::fill(array2dI[k], array2dI[k] + width, 1.0);
 
-			int globalCount = 0;
-			int idcsSize = idcs.size();
+				std::fill(array2dR[k], array2dR[k] + width, 255.0);
+				std::fill(array2dG[k], array2dG[k] + width, 255.0);
+				std::fill(array2dB[k], array2dB[k] + width, 255.0);
+			}	
 
-			//Transformando los valores que estaban en los vectores secuencialmente hacia las matrices (arreglos bidimensionales) HSI
-			for(int k = 0; k < idcsSize; k++)
-			{	
-				int zeroPadding = idcs[k].getZeroPadding();
-				int columnLength = idcs[k].getColumnLength();
+			//Segunda pasada: cada pixel se decodifica directamente en su posici&oacute;n de las matrices HSI,
+			//con un bloque de columnas por hilo
+			forEachBlock(blocks, [this, &table, array2dH, array2dS, array2dI](int first, int last)
+			{
+				//Los pixeles de la columna se decodifican en bloque y luego se copian a su columna de las matrices.
+				//Del mat&iacute;z s&oacute;lo se guarda bch3, por lo que no se lee la curva de mat&iacute;z
+				vector<double> columnS(height), columnI(height);
 
-				for (int i = zeroPadding; i < columnLength + zeroPadding; i++)
+				for(int k = first; k < last; k++)
 				{	
-					array2dH[i][k] = channelH[globalCount];
-					array2dS[i][k] = channelS[globalCount];
-					array2dI[i][k] = channelI[globalCount];
+					int zeroPadding = columnIndex[k].getZeroPadding();
+					int columnLength = columnIndex[k].getColumnLength();
+					if(columnLength == 0)
+						continue;
+
+					const byte *pixels = data + columnIndex[k].getStartByte() + 7;
+					PixelUnpacker::decode(pixels, columnLength, table, NULL, &columnS[0], &columnI[0]);
 
-					globalCount++;
+					for (int i = 0; i < columnLength; i++)
+					{
+						array2dH[zeroPadding + i][k] = pixels[i * 4 + 3];
+						array2dS[zeroPadding + i][k] = columnS[i];
+						array2dI[zeroPadding + i][k] = columnI[i];
+					}
 				}
-			}
+			});
 
 			//Filtrando el canal de intensidad para realzar bordes
-			imgFilter2D(array2dI, resultI);	
-
-			//Convirtiendo los valores de HSI a RGB
-			for(int k = 0; k < idcsSize; k++)
-			{	
-				int zeroPadding = idcs[k].getZeroPadding();
-				int columnLength = idcs[k].getColumnLength();
+			imgFilter2D(array2dI, resultI, width, height, columnIndex);	
 
-				for (int i = zeroPadding; i < columnLength + zeroPadding; i++)
-				{	
-					double valueR = convertHSI2RGB(array2dH[i][k], array2dS[i][k], resultI[i][k])[0];
-					double valueG = convertHSI2RGB(array2dH[i][k], array2dS[i][k], resultI[i][k])[1];
-					double valueB = convertHSI2RGB(array2dH[i][k], array2dS[i][k], resultI[i][k])[2];
-
-					array2dR[i][k] = valueR;
-					array2dG[i][k] = valueG;
-					array2dB[i][k] = valueB;
-				}
-			}
+			//Convirtiendo los valores de HSI a RGB fila por fila, con un bloque de filas por hilo
+			vector<int> rows = splitRows(height, (int)blocks.size() - 1);
+			forEachBlock(rows, [this, &hues, array2dH, array2dS, resultI](int first, int last)
+			{
+				convertRows(hues, array2dH, array2dS, resultI, width, columnIndex, first, last, array2dR, array2dG, array2dB);
+			});
 
 			//Eliminando los punteros utilizados
 			for(int k = 0; k < height; k++)
@@ -296,18 +465,306 @@ namespace img
 		}
 	}
 
-	void Format::imgFilter2D(double** &image, double** &result) 
+	const double Format::filter[Format::filterWidth][Format::filterHeight] =  
 	{ 
-		int const filterWidth = 3; 
-		int const filterHeight = 7; 
+		{-0.010561056105611,   0.190099009900990,  -0.359075907590759,  -1.351815181518151,   0.517491749174917,  -0.052805280528053, 0},
+		{0.039273927392740,  -0.706930693069306,   1.335313531353137,   5.027062706270626,  -1.924422442244224,   0.196369636963698, 0},
+		{-0.018811881188119,   0.338613861386138,  -0.639603960396040,  -2.407920792079207,   0.921782178217821,  -0.094059405940595, 0}
+	}; 
+
+	void Format::buildColumnIndex(void)
+	{
+		scanColumns(columnIndex);
+	}
+
+	void Format::scanColumns(ColumnIndex &index, ValidationReport *report)
+	{
+		if(startIndex == 0 && formatType != 0)			
+			throw invalid_argument("IMG header couldn't be opened.");
+
+		switch(formatType)
+		{
+		case FormatLayout1::formatType:
+			scanColumns<FormatLayout1>(index, report);
+			break;
+		case FormatLayout2::formatType:
+			scanColumns<FormatLayout2>(index, report);
+			break;
+		default:
+			throw invalid_argument("Invalid IMG format.");
+		}
+	}
 
-		double filter[filterWidth][filterHeight] =  
-		{ 
-			-0.010561056105611,   0.190099009900990,  -0.359075907590759,  -1.351815181518151,   0.517491749174917,  -0.052805280528053, 0,
-			0.039273927392740,  -0.706930693069306,   1.335313531353137,   5.027062706270626,  -1.924422442244224,   0.196369636963698, 0,
-			-0.018811881188119,   0.338613861386138,  -0.639603960396040,  -2.407920792079207,   0.921782178217821,  -0.094059405940595, 0
-		}; 
+	template<typename Layout>
+	void Format::scanColumns(ColumnIndex &index, ValidationReport *report)
+	{
+		index.clear();
 
+		//Mismas condiciones de parada que loadImageData(int), s&oacute;lo se leen los 8 bytes de cada columna
+		size_t position = startIndex - 1;
+		int columnLength, zeroPadding;
+
+		ValidationReport::Status status = ValidationReport::valid;
+
+		while ((int)index.size() < width)
+		{
+			status = readColumnRecord<Layout>(position, columnLength, zeroPadding);
+			if(status != ValidationReport::valid)
+				break;
+
+			index.add(ImageDataControl(position + 1, columnLength, zeroPadding));
+
+			position += Layout::columnHeaderSize + (size_t)columnLength * Layout::pixelSize;
+		}
+
+		if(report != NULL)
+		{
+			report->status = status;
+			report->validColumns = (int)index.size();
+			report->expectedColumns = width;
+			report->errorByte = status == ValidationReport::valid ? 0 : position;
+		}
+	}
+
+	bool Format::validate(ValidationReport &report)
+	{
+		report = ValidationReport();
+
+		if(formatType == 0)
+			report.status = ValidationReport::invalidFormat;
+		else if(startIndex == 0)
+			throw invalid_argument("IMG header couldn't be opened.");
+		else if(!available(startIndex - 1))
+		{
+			report.status = ValidationReport::truncatedHeader;
+			report.errorByte = dataSize;
+		}
+		else
+			scanColumns(columnIndex, &report);
+
+		report.fileSize = dataSize;
+
+		return report.isValid();
+	}
+
+	HSIColorTable Format::getColorTable(HSIColorTable::Precision precision) const
+	{
+		const Calibration *calibration = Calibration::forModel(model);
+		if(calibration != NULL)
+			return HSIColorTable(*calibration, precision);
+
+		return HSIColorTable(precision);
+	}
+
+	void Format::decodePixel(const byte *pixel, const HSIColorTable &table, double &valueH, double &valueS, double &valueI)
+	{
+		byte bch0 = pixel[0];
+		byte bch1 = pixel[1];
+		byte bch3 = pixel[3];
+
+		int indexI = (bch1 << 3) + (bch0 >> 5);
+		valueI = table.iCurve[indexI];
+		valueH = table.hCurve[bch3];
+
+		int bch3Control = 32;
+		bch3 = bch3 > bch3Control ? bch3Control : bch3;
+		valueS = table.sMatrix[indexI * (bch3Control + 1) + bch3];
+	}
+
+	void Format::decodeRegion(int x0, int x1, int y0, int y1, RGBImage &region)
+	{
+		if(columnIndex.size() == 0)
+			buildColumnIndex();
+
+		//El alto que tendr&aacute; la imagen completa, del que depende el borde circular del filtro
+		int fullHeight = columnIndex.getDataHeight() == 0 ? height : columnIndex.getDataHeight();
+
+		if(x0 < 0 || x1 > width || x0 >= x1 || y0 < 0 || y1 > fullHeight || y0 >= y1)
+			throw invalid_argument("Invalid IMG region.");
+
+		int const haloX = filterHeight / 2;
+		int const haloY = filterWidth / 2;
+
+		int regionWidth = x1 - x0;
+		int regionHeight = y1 - y0;
+		int windowWidth = regionWidth + 2 * haloX;
+		int windowHeight = regionHeight + 2 * haloY;
+		int columnCount = (int)columnIndex.size();
+
+		HSIColorTable table = getColorTable();
+		HueTable hues(table);
+
+		//Intensidad de la ventana con el halo, fila por fila; el fondo vale 1 igual que en loadImageData(int)
+		vector<double> window((size_t)windowWidth * windowHeight, 1.0);
+
+		for(int wx = 0; wx < windowWidth; wx++)
+		{
+			int column = (x0 - haloX + wx + width) % width;
+			if(column >= columnCount)
+				continue;
+
+			const ImageDataControl &idc = columnIndex[column];
+			const byte *pixels = columnPixels(idc);
+
+			for(int wy = 0; wy < windowHeight; wy++)
+			{
+				int row = (y0 - haloY + wy + fullHeight) % fullHeight;
+				if(row < idc.getZeroPadding() || row >= idc.getZeroPadding() + idc.getColumnLength())
+					continue;
+
+				double valueH, valueS;
+				decodePixel(pixels + (row - idc.getZeroPadding()) * 4, table, valueH, valueS, window[(size_t)wy * windowWidth + wx]);
+			}
+		}
+
+		region.resize(regionWidth, regionHeight);
+		region.fill(255);
+
+		for(int x = x0; x < x1 && x < columnCount; x++)
+		{
+			const ImageDataControl &idc = columnIndex[x];
+			const byte *pixels = columnPixels(idc);
+
+			int first = idc.getZeroPadding() > y0 ? idc.getZeroPadding() : y0;
+			int last = idc.getZeroPadding() + idc.getColumnLength() < y1 ? idc.getZeroPadding() + idc.getColumnLength() : y1;
+
+			for(int y = first; y < last; y++)
+			{
+				//Mismo orden de suma que imgFilter2D para obtener el mismo resultado
+				double value = 0.0;
+				for(int filterX = 0; filterX < filterWidth; filterX++)
+				{
+					const double *windowRow = &window[(size_t)(y - y0 + filterX) * windowWidth + (x - x0)];
+
+					for(int filterY = 0; filterY < filterHeight; filterY++)
+						value += windowRow[filterY] * filter[filterX][filterY];
+				}
+
+				const byte *pixel = pixels + (y - idc.getZeroPadding()) * 4;
+
+				double valueH, valueS, valueI;
+				decodePixel(pixel, table, valueH, valueS, valueI);
+
+				double rgb[3];
+				hues.convert(pixel[3], valueS, value > 1 ? 1 : value, rgb);
+
+				region.getChannelR()[y - y0][x - x0] = rgb[0];
+				region.getChannelG()[y - y0][x - x0] = rgb[1];
+				region.getChannelB()[y - y0][x - x0] = rgb[2];
+			}
+		}
+	}
+
+	void Format::decodePreview(int factor, RGBImage &preview)
+	{
+		if(factor != 2 && factor != 4 && factor != 8)
+			throw invalid_argument("Invalid IMG preview factor.");
+
+		if(columnIndex.size() == 0)
+			buildColumnIndex();
+
+		int fullHeight = columnIndex.getDataHeight() == 0 ? height : columnIndex.getDataHeight();
+		int previewWidth = (width + factor - 1) / factor;
+		int previewHeight = (fullHeight + factor - 1) / factor;
+		int columnCount = (int)columnIndex.size();
+
+		preview.resize(previewWidth, previewHeight);
+		preview.fill(255);
+
+		HSIColorTable table = getColorTable();
+
+		//El mat&iacute;z es un &aacute;ngulo: se promedia como vector (cos, sen) para que dos valores a ambos lados de 1
+		//no den un promedio en el lado opuesto del c&iacute;rculo. S&oacute;lo depende de bch3, por lo que el vector de
+		//cada valor de bch3 se calcula una vez
+		const double PI = std::atan(1.0) * 4;
+		double hueX[HueTable::size], hueY[HueTable::size];
+		for(int k = 0; k < HueTable::size; k++)
+		{
+			hueX[k] = cos(table.getHue(k) * 2 * PI);
+			hueY[k] = sin(table.getHue(k) * 2 * PI);
+		}
+
+		//Sumas de los valores HSI y cantidad de pixeles con datos de cada bloque de la columna de bloques actual
+		vector<double> sumX(previewHeight), sumY(previewHeight), sumS(previewHeight), sumI(previewHeight);
+		vector<int> count(previewHeight);
+
+		for(int blockX = 0; blockX < previewWidth; blockX++)
+		{
+			std::fill(sumX.begin(), sumX.end(), 0.0);
+			std::fill(sumY.begin(), sumY.end(), 0.0);
+			std::fill(sumS.begin(), sumS.end(), 0.0);
+			std::fill(sumI.begin(), sumI.end(), 0.0);
+			std::fill(count.begin(), count.end(), 0);
+
+			int firstColumn = blockX * factor;
+			int lastColumn = firstColumn + factor < width ? firstColumn + factor : width;
+
+			for(int x = firstColumn; x < lastColumn && x < columnCount; x++)
+			{
+				const ImageDataControl &idc = columnIndex[x];
+				const byte *pixel = columnPixels(idc);
+
+				for(int y = idc.getZeroPadding(); y < idc.getZeroPadding() + idc.getColumnLength(); y++, pixel += 4)
+				{
+					double valueH, valueS, valueI;
+					decodePixel(pixel, table, valueH, valueS, valueI);
+
+					int blockY = y / factor;
+					sumX[blockY] += hueX[pixel[3]];
+					sumY[blockY] += hueY[pixel[3]];
+					sumS[blockY] += valueS;
+					sumI[blockY] += valueI;
+					count[blockY]++;
+				}
+			}
+
+			for(int blockY = 0; blockY < previewHeight; blockY++)
+			{
+				if(count[blockY] == 0)
+					continue;
+
+				//Si los matices se anulan (sumX y sumY son 0) atan2 devuelve 0
+				double meanH = atan2(sumY[blockY], sumX[blockY]) / (2 * PI);
+				meanH = meanH < 0 ? meanH + 1 : meanH;
+
+				double rgb[3];
+				convertHSI2RGB(meanH, sumS[blockY] / count[blockY], sumI[blockY] / count[blockY], rgb);
+
+				//Los pixeles de fondo del bloque aportan blanco
+				int blockRows = (blockY + 1) * factor < fullHeight ? factor : fullHeight - blockY * factor;
+				double coverage = (double)count[blockY] / ((lastColumn - firstColumn) * blockRows);
+
+				preview.getChannelR()[blockY][blockX] = rgb[0] * coverage + 255 * (1 - coverage);
+				preview.getChannelG()[blockY][blockX] = rgb[1] * coverage + 255 * (1 - coverage);
+				preview.getChannelB()[blockY][blockX] = rgb[2] * coverage + 255 * (1 - coverage);
+			}
+		}
+	}
+
+	RawPixelView Format::getRawPixels(void)
+	{
+		if(columnIndex.size() == 0)
+			buildColumnIndex();
+
+		requestColumns(columnIndex);
+
+		int dataHeight = columnIndex.getDataHeight();
+
+		return RawPixelView(data, columnIndex, width, dataHeight == 0 ? height : dataHeight);
+	}
+
+	bool Format::loadColumnIndex(const char *path)
+	{
+		return columnIndex.load(path, source->getSize(), width, headerHeight, headerStartIndex);
+	}
+
+	bool Format::saveColumnIndex(const char *path) const
+	{
+		return columnIndex.save(path, source->getSize(), width, headerHeight, headerStartIndex);
+	}
+
+	void Format::imgFilter2D(double **image, double **result, int width, int height) 
+	{ 
 		//apply the filter 
 		for(int x = 0; x < height; x++) 
 			for(int y = 0; y < width; y++) 
@@ -329,7 +786,71 @@ namespace img
 			}    
 	}
 
-	double* Format::convertHSI2RGB(double valueH, double valueS, double valueI)
+	void Format::imgFilter2D(double **image, double **result, int width, int height, const ColumnIndex &spans)
+	{
+		int const haloX = filterWidth / 2;
+		int const haloY = filterHeight / 2;
+		int columnCount = (int)spans.size() < width ? (int)spans.size() : width;
+
+		for(int x = 0; x < height; x++)
+		{
+			//Las filas vecinas, con el mismo borde circular que imgFilter2D(double**, double**, int, int)
+			const double *rows[filterWidth];
+			for(int filterX = 0; filterX < filterWidth; filterX++)
+				rows[filterX] = image[(x - haloX + filterX + height) % height];
+
+			for(int y = 0; y < columnCount; y++)
+			{
+				//Los pixeles de fondo no se filtran: su intensidad filtrada no se usa
+				int zeroPadding = spans[y].getZeroPadding();
+				if(x < zeroPadding || x >= zeroPadding + spans[y].getColumnLength())
+					continue;
+
+				double value = 0.0;
+
+				if(y >= haloY && y + haloY < width)
+				{
+					for(int filterX = 0; filterX < filterWidth; filterX++)
+						for(int filterY = 0; filterY < filterHeight; filterY++)
+							value += rows[filterX][y - haloY + filterY] * filter[filterX][filterY];
+				}
+				else
+				{
+					for(int filterX = 0; filterX < filterWidth; filterX++)
+						for(int filterY = 0; filterY < filterHeight; filterY++)
+							value += rows[filterX][(y - haloY + filterY + width) % width] * filter[filterX][filterY];
+				}
+
+				result[x][y] = value > 1 ? 1 : value;
+			}
+		}
+	}
+
+	void Format::convertRows(const HueTable &hues, byte **array2dH, double **array2dS, double **array2dI, int width, const ColumnIndex &spans,
+		int firstRow, int lastRow, double **array2dR, double **array2dG, double **array2dB)
+	{
+		int columnCount = (int)spans.size() < width ? (int)spans.size() : width;
+
+		for(int x = firstRow; x < lastRow; x++)
+		{
+			int y = 0;
+			while(y < columnCount)
+			{
+				//Tramo de columnas consecutivas que tienen datos en la fila
+				int first = y;
+				while(y < columnCount && x >= spans[y].getZeroPadding() && x < spans[y].getZeroPadding() + spans[y].getColumnLength())
+					y++;
+
+				if(y > first)
+					hues.convertRow(array2dH[x] + first, array2dS[x] + first, array2dI[x] + first, y - first,
+						array2dR[x] + first, array2dG[x] + first, array2dB[x] + first);
+				else
+					y++;
+			}
+		}
+	}
+
+	void Format::convertHSI2RGB(double valueH, double valueS, double valueI, double *rgb)
 	{
 		const double PI = std::atan(1.0) * 4;
 
@@ -373,28 +894,28 @@ namespace img
 		g *= 255;
 		b *= 255;
 
-		double result[3] = {r, g, b};
-
-		return result;
+		rgb[0] = r;
+		rgb[1] = g;
+		rgb[2] = b;
 	}
 
 	short Format::read1Byte(int byteNum) {
 
-		return byteNum >= byteArray.size() ? 0 : (short)byteArray[byteNum - 1];
+		//byteNum cuenta desde 1: el byte byteNum existe si el archivo tiene byteNum bytes
+		return byteNum < 1 || !available(byteNum) ? 0 : (short)data[byteNum - 1];
 	}
 
 	double Format::read2Bytes(int byteInferior) {
 
-		return read1Byte(byteInferior + 1) * pow(2.0, 8.0) +
-			read1Byte(byteInferior);
+		return (uint16_t)(read1Byte(byteInferior + 1) << 8 | read1Byte(byteInferior));
 	}
 
 	double Format::read4Bytes(int byteInferior) {
 
-		return read1Byte(byteInferior + 3) * pow(2.0, 24.0) +
-			read1Byte(byteInferior + 2) * pow(2.0, 16.0) +
-			read1Byte(byteInferior + 1) * pow(2.0, 8.0) +
-			read1Byte(byteInferior);
+		return (uint32_t)read1Byte(byteInferior + 3) << 24 |
+			(uint32_t)read1Byte(byteInferior + 2) << 16 |
+			(uint32_t)read1Byte(byteInferior + 1) << 8 |
+			(uint32_t)read1Byte(byteInferior);
 	}
 
 	string Format::getString(int inf, int superior) {
@@ -402,7 +923,7 @@ namespace img
 		string resultado = "";
 
 		for (int i = inf; i < superior; i++)
-			resultado += (char)read2Bytes(i * 2 - 1);
+			resultado += (char)read1Byte(i * 2 - 1);
 
 		return resultado;
 	}
@@ -25,7 +25,16 @@
 #include <string>
 #include <stdexcept>
 #include "ImageDataControl.h"
+#include "ColumnIndex.h"
 #include "HSIColorTable.h"
+#include "HueTable.h"
+#include "ByteSource.h"
+#include "ByteReader.h"
+#include "FormatLayout.h"
+#include "ImageHeader.h"
+#include "RGBImage.h"
+#include "RawPixelView.h"
+#include "ValidationReport.h"
 
 using namespace std;
 typedef unsigned char byte;
@@ -60,6 +69,13 @@ namespace img
 		* El alto de la imagen.
 		*/
 		int height;		
+
+		/**
+		* El alto y el byte de inicio de los datos seg&uacute;n la cabecera: loadImageData(int) cambia height por el
+		* alto de los datos y startIndex por el final de la &uacute;ltima columna.
+		*/
+		int headerHeight;
+		long headerStartIndex;
 		
 		/**
 		* El modelo del equipo de Rayos X, en caso de que fuera generada la imagen por un equipo.
@@ -114,6 +130,31 @@ namespace img
 		*/
 		double **array2dB;
 
+		/**
+		* El &iacute;ndice de las columnas del campo de datos.
+		*/
+		ColumnIndex columnIndex;
+
+		/**
+		* El origen de los bytes del archivo IMG.
+		*/
+		ByteSource *source;
+
+		/**
+		* Indica si el origen de los bytes fue creado por la clase y debe ser liberado en el destructor.
+		*/
+		bool ownsSource;
+
+		/**
+		* Puntero a los bytes del archivo IMG disponibles en el origen.
+		*/
+		const byte *data;
+
+		/**
+		* Cantidad de bytes del archivo IMG disponibles en el origen.
+		*/
+		size_t dataSize;
+
 	public:
 		/**
 		* Identificador del tipo de formato del archivo IMG, respecto a la versi&oacute;n del software con que fue creado.
@@ -130,6 +171,12 @@ namespace img
 		* El alto de la imagen.
 		*/
 		inline int getHeight() const {return this->height;}
+
+		/**
+		* N&uacute;mero del byte donde comienzan los datos de la imagen. Luego de llamar loadImageData(int)
+		* es el n&uacute;mero del byte siguiente a la &uacute;ltima columna le&iacute;da.
+		*/
+		inline long getStartIndex() const {return this->startIndex;}
 		
 		/**
 		* El modelo del equipo de Rayos X, en caso de que fuera generada la imagen por un equipo.
@@ -169,6 +216,17 @@ namespace img
 		*/
 		inline double getImageBytes() const {return this->imageBytes;}	
 
+		/**
+		* Los datos de la cabecera del fichero IMG. Debe ser llamado despu&eacute;s del m&eacute;todo loadHeaderData(void).
+		*/
+		ImageHeader getHeader() const;
+
+		/**
+		* El &iacute;ndice de las columnas del campo de datos. Se construye con buildColumnIndex(void), se carga con 
+		* loadColumnIndex(const char*) o se llena al llamar loadImageData(int).
+		*/
+		inline const ColumnIndex &getColumnIndex() const {return this->columnIndex;}
+
 		/**
 		* El arreglo bidimensional(matriz) que hace referencia al canal de Rojo de la imagen del fichero IMG.
 		*/
@@ -196,17 +254,40 @@ namespace img
 		* Aplica el filtro correspondiente de realce de bordes a la imagen pasada por par&aacute;metro
 		* @param image La matriz de la imagen que se desea pasar el filtro.
 		* @param result La matriz resultante de la aplicaci&oacute;n del filtro.
+		* @param width El ancho de las matrices.
+		* @param height El alto de las matrices.
 		*/
-		void imgFilter2D(double** &image, double** &result);
+		static void imgFilter2D(double **image, double **result, int width, int height);
 
 		/**
-		* Convierte a RGB los 3 valores de un pixel de una imagen en formato HSI.
-		* @param valueH El valor de la componente de mat&iacute;z de la imagen en formato HSI.
-		* @param valueS El valor de la componente de saturaci&oacute;n de la imagen en formato HSI.
-		* @param valueI El valor de la componente de intensidad de la imagen en formato HSI.
-		* @return Un arreglo de tres valores, [0] = Rojo, [1] = Verde, [2] = Azul.
+		* Aplica el filtro de realce de bordes s&oacute;lo a los pixeles con datos de cada columna. El resultado en esos
+		* pixeles es id&eacute;ntico al de imgFilter2D(double**, double**, int, int); los pixeles de fondo de result no
+		* se modifican.
+		* @param image La matriz de la imagen que se desea pasar el filtro, con intensidad 1 en el fondo.
+		* @param result La matriz resultante de la aplicaci&oacute;n del filtro.
+		* @param width El ancho de las matrices.
+		* @param height El alto de las matrices.
+		* @param spans El &iacute;ndice de columnas, con la longitud de fondo y el tama&ntilde;o de cada columna.
 		*/
-		double* convertHSI2RGB(double valueH, double valueS, double valueI);
+		static void imgFilter2D(double **image, double **result, int width, int height, const ColumnIndex &spans);
+
+		/**
+		* Convierte a RGB un grupo de filas de las matrices HSI, por tramos de columnas consecutivas con datos en
+		* cada fila; los pixeles de fondo no se modifican.
+		* @param hues La tabla de mat&iacute;z.
+		* @param array2dH Los valores de bch3 de cada pixel.
+		* @param array2dS Los valores de saturaci&oacute;n.
+		* @param array2dI Los valores de intensidad filtrada.
+		* @param width El ancho de las matrices.
+		* @param spans El &iacute;ndice de columnas con la longitud de fondo y el tama&ntilde;o de cada columna.
+		* @param firstRow La primera fila.
+		* @param lastRow La fila siguiente a la &uacute;ltima.
+		* @param array2dR Los valores de rojo.
+		* @param array2dG Los valores de verde.
+		* @param array2dB Los valores de azul.
+		*/
+		static void convertRows(const HueTable &hues, byte **array2dH, double **array2dS, double **array2dI, int width, const ColumnIndex &spans,
+			int firstRow, int lastRow, double **array2dR, double **array2dG, double **array2dB);
 
 		/**
 		* Busca identificador del tipo de formato del archivo IMG, respecto a la versi&oacute;n del software con que fue creado.
@@ -217,14 +298,133 @@ namespace img
 		*/
 		void whatFormat();
 
+		/**
+		* Copia los primeros headerProbeSize bytes del archivo, donde est&aacute;n todos los campos de la cabecera.
+		* Los bytes que no existen en el archivo quedan en 0.
+		* @param header El bloque de headerProbeSize bytes donde se copian.
+		*/
+		void copyHeader(byte *header);
+
+		/**
+		* Lee la estructura de una columna del campo de datos y comprueba que la columna completa, con sus
+		* pixeles, est&eacute; disponible y quepa en el alto de la imagen.
+		* @param position La posici&oacute;n (desde 0) del primer byte de la estructura.
+		* @param columnLength El tama&ntilde;o de la columna.
+		* @param zeroPadding La longitud de fondo de la columna.
+		* @return El estado de la columna; si no es ValidationReport::valid la columna termina el campo de datos.
+		*/
+		template<typename Layout>
+		ValidationReport::Status readColumnRecord(size_t position, int &columnLength, int &zeroPadding);
+
+		/**
+		* Lee los campos de la cabecera con las posiciones de una versi&oacute;n del formato.
+		* @param header Los primeros headerProbeSize bytes del archivo.
+		*/
+		template<typename Layout>
+		void loadHeaderFields(const ByteReader &header);
+
+		/**
+		* Recorre las columnas del campo de datos con la estructura de una versi&oacute;n del formato.
+		* @see scanColumns(ColumnIndex&, ValidationReport*)
+		*/
+		template<typename Layout>
+		void scanColumns(ColumnIndex &index, ValidationReport *report);
+
+		/**
+		* Pide al origen los bytes de todas las columnas de un &iacute;ndice.
+		* @param index El &iacute;ndice de columnas.
+		* @throw invalid_argument si el &iacute;ndice tiene columnas fuera del archivo.
+		*/
+		void requestColumns(const ColumnIndex &index);
+
+		/**
+		* Construye un &iacute;ndice de las columnas del campo de datos, como buildColumnIndex(void), en un
+		* &iacute;ndice ajeno a este objeto.
+		* @param index El &iacute;ndice donde se guardan las columnas; su contenido anterior se descarta.
+		* @param report Si no es NULL, se guarda d&oacute;nde y por qu&eacute; termin&oacute; el campo de datos.
+		*/
+		void scanColumns(ColumnIndex &index, ValidationReport *report = NULL);
+
+		/**
+		* Puntero a los pixeles de una columna del &iacute;ndice, comprobando que todos est&eacute;n disponibles.
+		* @param idc La estructura de la columna.
+		* @return El primer byte del primer pixel de la columna.
+		*/
+		const byte *columnPixels(const ImageDataControl &idc);
+
+		/**
+		* La tabla de colores del modelo del equipo: la calibraci&oacute;n del modelo si tiene fichero, o la
+		* compilada en el programa.
+		* @param precision La precisi&oacute;n de los valores de la tabla.
+		* @see Calibration::forModel(const std::string&)
+		*/
+		HSIColorTable getColorTable(HSIColorTable::Precision precision = HSIColorTable::doublePrecision) const;
+
+		/**
+		* Decodifica los valores HSI de un pixel del campo de datos.
+		* @param pixel El primero de los 4 bytes del pixel.
+		* @param table La tabla de colores HSI.
+		* @param valueH El valor de la componente de mat&iacute;z.
+		* @param valueS El valor de la componente de saturaci&oacute;n.
+		* @param valueI El valor de la componente de intensidad.
+		*/
+		static void decodePixel(const byte *pixel, const HSIColorTable &table, double &valueH, double &valueS, double &valueI);
+
+		/**
+		* Comprueba que los bytes del archivo IMG est&eacute;n disponibles hasta la posici&oacute;n dada, 
+		* pidi&eacute;ndolos al origen si es necesario.
+		* @param end La cantidad de bytes que se necesitan desde el inicio del archivo.
+		* @return true si los bytes est&aacute;n disponibles.
+		*/
+		bool available(size_t end);
+
 	public:
 		/**
-		* Vector con los bytes del archivo IMG cargado.
+		* Cantidad de filas del filtro de realce de bordes.
+		*/
+		static const int filterWidth = 3;
+
+		/**
+		* Cantidad de columnas del filtro de realce de bordes.
+		*/
+		static const int filterHeight = 7;
+
+		/**
+		* Coeficientes del filtro de realce de bordes que se aplica al canal de intensidad.
 		*/
-		vector<byte> byteArray;
+		static const double filter[filterWidth][filterHeight];
 
 		/**
-		* Constructor de la clase Format. Luego de creado el objeto a trav&eacute;s de este constructor
+		* Cantidad de bytes del inicio del fichero IMG que contienen todos los datos de la cabecera de 
+		* ambos formatos (hasta el byte 825 en el formato 1 y 245 en el formato 2).
+		*/
+		static const int headerProbeSize = 1024;
+
+		/**
+		* Lee s&oacute;lo los datos de la cabecera de un fichero IMG, sin cargar el resto del fichero. Se leen
+		* &uacute;nicamente los primeros headerProbeSize bytes, lo que permite extraer los datos de muchos 
+		* ficheros a la velocidad de acceso del disco.
+		* @param fullImageName La direcci&oacute;n del archivo IMG.
+		* @param header Los datos de la cabecera le&iacute;dos.
+		* @return true si el fichero pudo ser le&iacute;do y es un formato v&aacute;lido.
+		*/
+		static bool probeHeader(const char *fullImageName, ImageHeader &header);
+
+		/**
+		* Convierte a RGB los 3 valores de un pixel de una imagen en formato HSI. La decodificaci&oacute;n de los
+		* pixeles utiliza HueTable, que evita las funciones trigonom&eacute;tricas; esta funci&oacute;n se mantiene para
+		* valores de mat&iacute;z que no salen de la tabla, como los promedios de decodePreview(int, RGBImage&).
+		* @param valueH El valor de la componente de mat&iacute;z de la imagen en formato HSI.
+		* @param valueS El valor de la componente de saturaci&oacute;n de la imagen en formato HSI.
+		* @param valueI El valor de la componente de intensidad de la imagen en formato HSI.
+		* @param rgb Un arreglo de tres valores donde se escribe el resultado, [0] = Rojo, [1] = Verde, [2] = Azul.
+		*/
+		static void convertHSI2RGB(double valueH, double valueS, double valueI, double *rgb);
+
+		/**
+		* Constructor de la clase Format. El archivo se proyecta en memoria y sus bytes se leen directamente
+		* de la proyecci&oacute;n; si la proyecci&oacute;n falla se copian a un buffer en memoria.
+		* Luego de creado el objeto a trav&eacute;s de este constructor
 		* se debe llamar el m&eacute;todo getFormatType() para comprobar que se ha cargado un 
 		* fichero IMG v&aacute;lido.
 		* @param fullImageName La direcci&oacute;n del archivo IMG.
@@ -232,26 +432,111 @@ namespace img
 		*/
 		Format(const char* fullImageName);
 
+		/**
+		* Constructor de la clase Format a partir de un origen de bytes. Los bytes se leen directamente del
+		* origen, que debe mantenerse v&aacute;lido mientras exista el objeto. Luego de creado el objeto 
+		* se debe llamar el m&eacute;todo getFormatType() para comprobar que se ha cargado un 
+		* fichero IMG v&aacute;lido.
+		* @param source El origen de los bytes del archivo IMG.
+		* @see getFormatType()
+		*/
+		Format(ByteSource &source);
+
 		/**
 		* Destructor de la clase Format.
 		*/
 		~Format(void);
 
 		/**
-		* Carga la cabecera del formato IMG. Este m&eacute;todo debe ser llamado antes del m&eacute;todo loadImageData(void).
+		* Carga la cabecera del formato IMG. Este m&eacute;todo debe ser llamado antes del m&eacute;todo loadImageData(int).
 		*/
 		void loadHeaderData(void);
 
 		/**
 		* Carga los datos de la imagen del formato IMG. Este m&eacute;todo debe ser llamado despu&eacute;s 
-		* del m&eacute;todo loadHeaderData(void).
+		* del m&eacute;todo loadHeaderData(void). Las columnas se reparten entre varios hilos a partir del
+		* &iacute;ndice de columnas, en bloques con aproximadamente la misma cantidad de pixeles.
+		* @param threads Cantidad de hilos; 0 utiliza un hilo por procesador.
+		*/
+		void loadImageData(int threads = 0);
+
+		/**
+		* Decodifica s&oacute;lo una ventana de la imagen. Se leen &uacute;nicamente las columnas de la ventana y las
+		* vecinas que necesita el filtro de realce de bordes (3 filas y 7 columnas), y el resultado es 
+		* id&eacute;ntico al de loadImageData(int) en esa ventana. Este m&eacute;todo debe ser llamado despu&eacute;s del 
+		* m&eacute;todo loadHeaderData(void); si el &iacute;ndice de columnas est&aacute; vac&iacute;o se construye primero.
+		* @param x0 La primera columna de la ventana.
+		* @param x1 La columna siguiente a la &uacute;ltima columna de la ventana.
+		* @param y0 La primera fila de la ventana.
+		* @param y1 La fila siguiente a la &uacute;ltima fila de la ventana.
+		* @param region La imagen donde se escribe la ventana, de (x1 - x0) columnas y (y1 - y0) filas.
+		*/
+		void decodeRegion(int x0, int x1, int y0, int y1, RGBImage &region);
+
+		/**
+		* Decodifica una vista previa de la imagen a una fracci&oacute;n de su tama&ntilde;o. Los valores HSI de los pixeles
+		* de cada bloque de factor x factor se promedian antes de convertirlos a RGB, por lo que se hace una sola 
+		* conversi&oacute;n por bloque, y no se aplica el filtro de realce de bordes. El mat&iacute;z se promedia como
+		* &aacute;ngulo (media circular), porque la curva de mat&iacute;z de una calibraci&oacute;n puede pasar por 1. El fondo de cada bloque se mezcla 
+		* con el color de fondo (blanco) en proporci&oacute;n a la cantidad de pixeles de fondo. Este m&eacute;todo debe 
+		* ser llamado despu&eacute;s del m&eacute;todo loadHeaderData(void); si el &iacute;ndice de columnas est&aacute; 
+		* vac&iacute;o se construye primero.
+		* @param factor La reducci&oacute;n de la imagen: 2, 4 u 8.
+		* @param preview La imagen donde se escribe la vista previa, del ancho y alto de la imagen divididos por 
+		* el factor y redondeados hacia arriba.
+		*/
+		void decodePreview(int factor, RGBImage &preview);
+
+		/**
+		* Vista de los bytes sin decodificar de los pixeles (los 4 canales de cada pixel), sin copiarlos. 
+		* Este m&eacute;todo debe ser llamado despu&eacute;s del m&eacute;todo loadHeaderData(void); si el &iacute;ndice de 
+		* columnas est&aacute; vac&iacute;o se construye primero.
+		* @return La vista, v&aacute;lida mientras exista este objeto.
+		* @see RawPixelView
 		*/
-		void loadImageData(void);
+		RawPixelView getRawPixels(void);
+
+		/**
+		* Construye el &iacute;ndice de las columnas del campo de datos sin decodificar la imagen. S&oacute;lo se leen
+		* los 8 bytes de la estructura de cada columna y se salta directamente a la siguiente. Este m&eacute;todo
+		* debe ser llamado despu&eacute;s del m&eacute;todo loadHeaderData(void).
+		*/
+		void buildColumnIndex(void);
+
+		/**
+		* Comprueba la estructura del fichero sin decodificar la imagen, en tiempo proporcional a la cantidad de
+		* columnas: s&oacute;lo se leen los 8 bytes de la estructura de cada columna. El &iacute;ndice de columnas queda
+		* construido con las columnas correctas, por lo que loadImageData(int) no vuelve a recorrerlas.
+		*
+		* Para rechazar un fichero da&ntilde;ado basta con no decodificarlo. Para recuperarlo se llama de todas formas
+		* loadImageData(int), que decodifica las ValidationReport::validColumns primeras columnas y deja el resto
+		* de la imagen de fondo. Este m&eacute;todo debe ser llamado despu&eacute;s del m&eacute;todo loadHeaderData(void) y 
+		* antes de loadImageData(int).
+		* @param report El resultado de la comprobaci&oacute;n.
+		* @return true si el fichero es correcto.
+		*/
+		bool validate(ValidationReport &report);
+
+		/**
+		* Carga el &iacute;ndice de las columnas de un fichero creado con saveColumnIndex(const char*). Debe ser
+		* llamado despu&eacute;s del m&eacute;todo loadHeaderData(void).
+		* @param path La direcci&oacute;n del fichero del &iacute;ndice.
+		* @return true si el &iacute;ndice fue cargado: corresponde al tama&ntilde;o y la cabecera de este archivo IMG y
+		* todas sus columnas caben en la imagen y en el fichero.
+		*/
+		bool loadColumnIndex(const char *path);
+
+		/**
+		* Guarda el &iacute;ndice de las columnas en un fichero, normalmente junto al archivo IMG.
+		* @param path La direcci&oacute;n del fichero del &iacute;ndice.
+		* @return true si el fichero fue escrito.
+		*/
+		bool saveColumnIndex(const char *path) const;
 
 		/**
 		* Lee un byte del vector de los bytes del fichero IMG.
-		* @param byteNum El n&uacute;mero del byte, la posici&oacute;n del byte que se desea leer.
-		* @return El valor del byte.
+		* @param byteNum El n&uacute;mero del byte (desde 1), la posici&oacute;n del byte que se desea leer.
+		* @return El valor del byte, 0 si el archivo no tiene ese byte.
 		*/
 		short read1Byte(int byteNum);
 
@@ -276,6 +561,12 @@ namespace img
 		* @return El texto de la lectura.
 		*/
 		string getString(int inf, int superior);
+
+	private:
+		friend class Decoder;
+
+		Format(const Format &);
+		Format &operator=(const Format &);
 	};
 }
 
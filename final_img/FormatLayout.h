@@ -0,0 +1,132 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef FORMATLAYOUT_H
+#define FORMATLAYOUT_H
+
+#include <stddef.h>
+#include "ByteReader.h"
+
+namespace img
+{
+	/**
+	* Estructura del campo de datos, igual en todas las versiones del formato IMG: cada columna tiene
+	* una estructura de 8 bytes (tama&ntilde;o, longitud de fondo y ZM) seguida de 4 bytes por pixel.
+	*/
+	struct ColumnLayout
+	{
+		/**
+		* Posici&oacute;n del tama&ntilde;o de la columna (2 bytes) dentro de la estructura.
+		*/
+		static constexpr size_t columnLengthOffset = 0;
+
+		/**
+		* Posici&oacute;n de la longitud de fondo (2 bytes) dentro de la estructura.
+		*/
+		static constexpr size_t zeroPaddingOffset = 2;
+
+		/**
+		* Tama&ntilde;o de la estructura: 2 bytes de CL + 2 bytes de ZP + 4 bytes de ZM.
+		*/
+		static constexpr size_t columnHeaderSize = 8;
+
+		/**
+		* Cantidad de bytes de cada pixel.
+		*/
+		static constexpr size_t pixelSize = 4;
+	};
+
+	/**
+	* Posiciones (desde 0) de los campos de la cabecera del formato 1. Cada versi&oacute;n del formato IMG se
+	* describe con una estructura como esta; Format instancia con ella el lector de la cabecera y el
+	* recorrido de las columnas, por lo que las posiciones son constantes en el c&oacute;digo generado.
+	* Para agregar una versi&oacute;n basta con una nueva estructura y su caso en Format.
+	*/
+	struct FormatLayout1 : ColumnLayout
+	{
+		/**
+		* Identificador del tipo de formato.
+		*/
+		static constexpr int formatType = 1;
+
+		static constexpr size_t widthOffset = 648;
+		static constexpr size_t heightOffset = 650;
+		static constexpr size_t dataBytesOffset = 640;
+		static constexpr size_t imageBytesOffset = 656;
+
+		static constexpr size_t modelOffset = 664;
+		static constexpr size_t modelLength = 11;
+		static constexpr size_t dateOffset = 696;
+		static constexpr size_t dateLength = 19;
+		static constexpr size_t systemIdOffset = 764;
+		static constexpr size_t systemIdLength = 10;
+
+		/**
+		* El formato tiene n&uacute;mero de secuencia (4 bytes).
+		*/
+		static constexpr bool hasSequenceNumber = true;
+		static constexpr size_t sequenceNumberOffset = 660;
+
+		/**
+		* El formato tiene intensidad de los rayos X (2 bytes, en d&eacute;cimas de K/V).
+		*/
+		static constexpr bool hasRayIntensity = true;
+		static constexpr size_t rayIntensityOffset = 798;
+
+		/**
+		* N&uacute;mero del byte (desde 1) donde comienzan los datos de la imagen.
+		*/
+		static constexpr long startIndex = 825;
+
+		/**
+		* Indica si un fichero con la firma IMG es de esta versi&oacute;n.
+		*/
+		static bool matches(const ByteReader &header) { return header.read8(22) > 100; }
+	};
+
+	/**
+	* Posiciones (desde 0) de los campos de la cabecera del formato 2.
+	* @see FormatLayout1
+	*/
+	struct FormatLayout2 : ColumnLayout
+	{
+		static constexpr int formatType = 2;
+
+		static constexpr size_t widthOffset = 68;
+		static constexpr size_t heightOffset = 70;
+		static constexpr size_t dataBytesOffset = 60;
+		static constexpr size_t imageBytesOffset = 76;
+
+		static constexpr size_t modelOffset = 84;
+		static constexpr size_t modelLength = 8;
+		static constexpr size_t dateOffset = 114;
+		static constexpr size_t dateLength = 20;
+		static constexpr size_t systemIdOffset = 764;
+		static constexpr size_t systemIdLength = 10;
+
+		static constexpr bool hasSequenceNumber = false;
+		static constexpr size_t sequenceNumberOffset = 0;
+
+		static constexpr bool hasRayIntensity = false;
+		static constexpr size_t rayIntensityOffset = 0;
+
+		static constexpr long startIndex = 245;
+
+		static bool matches(const ByteReader &header) { return header.read8(22) <= 100; }
+	};
+}
+
+#endif // FORMATLAYOUT_H
@@ -17,39 +17,138 @@
 #ifndef HSICOLORTABLE_H
 #define HSICOLORTABLE_H
 
+#include <stdint.h>
+#include "Calibration.h"
+
 namespace img
 {
 	/**
-	* Define los valores de la tabla de colores para el formato HSI
+	* Define los valores de la tabla de colores para el formato HSI. Los valores son los de una calibraci&oacute;n:
+	* la compilada en el programa o la de un fichero (Calibration). Son datos constantes compartidos por todas
+	* las instancias, por lo que construir una tabla no reserva memoria ni copia valores.
+	*
+	* Adem&aacute;s de los valores double, una tabla puede tener copias de menor precisi&oacute;n que ocupan menos
+	* cach&eacute; durante la decodificaci&oacute;n (la matriz de saturaci&oacute;n pasa de 528 KB a 264 KB en float y a
+	* 132 KB en punto fijo). Las copias de cada calibraci&oacute;n se calculan la primera vez que se piden y
+	* tambi&eacute;n se comparten.
+	* Diferencia m&aacute;xima medida en los canales RGB (de 0 a 255) de la imagen final respecto a la tabla
+	* double: 0.0001 con float y 0.011 con punto fijo de 16 bits. Al convertir a 8 bits s&oacute;lo cambian en 1
+	* los valores que quedan en el l&iacute;mite del redondeo.
 	*/
 	class HSIColorTable
 	{
 	public:
 		/**
-		* Constructor de la clase.
+		* Precisi&oacute;n de los valores que se leen al decodificar los pixeles.
+		*/
+		enum Precision
+		{
+			/**
+			* Valores double, los valores originales de la tabla.
+			*/
+			doublePrecision,
+
+			/**
+			* Valores float.
+			*/
+			singlePrecision,
+
+			/**
+			* Valores de 16 bits en punto fijo: el valor es v / fixedOne.
+			*/
+			fixedPoint16,
+
+			/**
+			* Valores de 16 bits en punto fijo en una sola tabla: H, S e I de cada pixel se leen juntos con un
+			* acceso a memoria (Calibration::getFusedValues). Da los mismos valores que fixedPoint16, que se
+			* utiliza en su lugar si la calibraci&oacute;n no permite la tabla combinada.
+			*/
+			fusedFixed16
+		};
+
+		/**
+		* El valor 1 en punto fijo; todos los valores de la tabla est&aacute;n entre 0 y 1.
+		*/
+		static const int fixedOne = 65535;
+
+		/**
+		* Constructor de la clase. Utiliza la calibraci&oacute;n compilada en el programa.
+		* @param precision La precisi&oacute;n de los valores que se leen al decodificar los pixeles.
+		*/
+		HSIColorTable(Precision precision = doublePrecision);
+
+		/**
+		* Constructor de la clase. Utiliza una calibraci&oacute;n que debe existir mientras exista la tabla.
+		* @param calibration La calibraci&oacute;n.
+		* @param precision La precisi&oacute;n de los valores que se leen al decodificar los pixeles.
+		*/
+		HSIColorTable(const Calibration &calibration, Precision precision = doublePrecision);
+
+		/**
+		* Devuelve la precisi&oacute;n de los valores que se leen al decodificar los pixeles.
+		*/
+		inline Precision getPrecision(void) const { return this->precision; }
+
+		/**
+		* Devuelve el valor de mat&iacute;z de un valor de bch3 con la precisi&oacute;n de la tabla, el mismo que se
+		* obtiene al decodificar un pixel.
+		* @param bch3 El cuarto byte del pixel.
 		*/
-		HSIColorTable();
+		double getHue(int bch3) const;
 
 		/**
-		* Destructor de la clase.
+		* Devuelve la calibraci&oacute;n de donde salen los valores de la tabla.
 		*/
-		~HSIColorTable();
+		inline const Calibration &getCalibration(void) const { return *this->calibration; }
+
+	private:
+		/**
+		* La precisi&oacute;n de los valores que se leen al decodificar los pixeles.
+		*/
+		Precision precision;
+
+		/**
+		* La calibraci&oacute;n de donde salen los valores.
+		*/
+		const Calibration *calibration;
+
+		/**
+		* Toma los valores de una calibraci&oacute;n.
+		*/
+		void setCalibration(const Calibration &calibration, Precision precision);
 
 	public:
 		/**
 		* Los valores estimados de la curva de mat&iacute;z.
 		*/
-		double *hCurve;
+		const double *hCurve;
 
 		/**
 		* Los valores estimados de la curva intensidad.
 		*/
-		double *iCurve;
+		const double *iCurve;
 
 		/**
 		* Los valores estimados de la matriz de saturaci&oacute;n respecto a los valores de intensidad y mat&iacute;z.
 		*/
-		double *sMatrix;
+		const double *sMatrix;
+
+		/**
+		* Los valores float de las curvas y la matriz, NULL si la precisi&oacute;n no es singlePrecision.
+		*/
+		const float *hCurveSingle, *iCurveSingle, *sMatrixSingle;
+
+		/**
+		* Los valores en punto fijo de las curvas y la matriz, NULL si la precisi&oacute;n no es fixedPoint16.
+		* Cada arreglo tiene un valor 0 adicional al final para poder leerlo de 4 en 4 bytes.
+		*/
+		const uint16_t *hCurveFixed, *iCurveFixed, *sMatrixFixed;
+
+		/**
+		* La tabla combinada, 4 valores por cada &iacute;ndice de la matriz de saturaci&oacute;n, NULL si la precisi&oacute;n no
+		* es fusedFixed16.
+		*/
+		const uint16_t *fused;
 	};
 }
 
@@ -0,0 +1,194 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include <cmath>
+#include "HueTable.h"
+#include "Simd.h"
+
+namespace img
+{
+	HueTable::HueTable()
+	{
+		build(HSIColorTable());
+	}
+
+	HueTable::HueTable(const HSIColorTable &table)
+	{
+		build(table);
+	}
+
+	void HueTable::build(const HSIColorTable &table)
+	{
+		const double PI = std::atan(1.0) * 4;
+
+		for(int k = 0; k < size; k++)
+		{
+			//Los mismos c&aacute;lculos que Format::convertHSI2RGB para obtener el mismo sector
+			double h = table.getHue(k) * 2 * PI;
+
+			if(h >= 0 && h < 2 * PI / 3)
+			{
+				sectors[k] = 0;
+				ratios[k] = cos(h) / cos(PI / 3 - h);
+			}
+			else if(h >= 2 * PI / 3 && h < 4 * PI / 3)
+			{
+				sectors[k] = 1;
+				ratios[k] = cos(h - 2 * PI / 3) / cos(PI - h);
+			}
+			else
+			{
+				sectors[k] = 2;
+				ratios[k] = cos(h - 4 * PI / 3) / cos(5 * PI / 3 - h);
+			}
+		}
+	}
+
+	static void convertScalar(const HueTable &table, const byte *hues, const double *valuesS, const double *valuesI, int count,
+		double *valuesR, double *valuesG, double *valuesB)
+	{
+		for(int k = 0; k < count; k++)
+		{
+			double rgb[3];
+			table.convert(hues[k], valuesS[k], valuesI[k], rgb);
+
+			valuesR[k] = rgb[0];
+			valuesG[k] = rgb[1];
+			valuesB[k] = rgb[2];
+		}
+	}
+
+#ifdef IMG_SIMD_SSE41
+	/**
+	* Limita los valores entre 0 y 1 y los lleva al intervalo entre 0 y 255, como la versi&oacute;n escalar:
+	* min y max devuelven el segundo operando si alguno no es un n&uacute;mero.
+	*/
+	IMG_TARGET("sse4.1")
+	static inline __m128d clamp(__m128d value)
+	{
+		value = _mm_max_pd(_mm_setzero_pd(), _mm_min_pd(_mm_set1_pd(1.0), value));
+		return _mm_mul_pd(value, _mm_set1_pd(255.0));
+	}
+
+	IMG_TARGET("sse4.1")
+	static void convertSse41(const HueTable &table, const int *sectors, const double *ratios, const byte *hues, const double *valuesS,
+		const double *valuesI, int count, double *valuesR, double *valuesG, double *valuesB)
+	{
+		const __m128d one = _mm_set1_pd(1.0);
+		const __m128d three = _mm_set1_pd(3.0);
+
+		int k = 0;
+		for(; k + 2 <= count; k += 2)
+		{
+			__m128d ratio = _mm_set_pd(ratios[hues[k + 1]], ratios[hues[k]]);
+			__m128i sector = _mm_set_epi64x(sectors[hues[k + 1]], sectors[hues[k]]);
+			__m128d is0 = _mm_castsi128_pd(_mm_cmpeq_epi64(sector, _mm_setzero_si128()));
+			__m128d is1 = _mm_castsi128_pd(_mm_cmpeq_epi64(sector, _mm_set1_epi64x(1)));
+
+			__m128d s = _mm_loadu_pd(valuesS + k);
+			__m128d i = _mm_loadu_pd(valuesI + k);
+
+			__m128d low = _mm_mul_pd(i, _mm_sub_pd(one, s));
+			__m128d main = _mm_mul_pd(i, _mm_add_pd(one, _mm_mul_pd(s, ratio)));
+			__m128d rest = _mm_sub_pd(_mm_mul_pd(three, i), _mm_add_pd(main, low));
+
+			//Sector 0: R, G, B = principal, restante, menor; sector 1: menor, principal, restante; sector 2: restante, menor, principal
+			_mm_storeu_pd(valuesR + k, clamp(_mm_blendv_pd(_mm_blendv_pd(rest, low, is1), main, is0)));
+			_mm_storeu_pd(valuesG + k, clamp(_mm_blendv_pd(_mm_blendv_pd(low, main, is1), rest, is0)));
+			_mm_storeu_pd(valuesB + k, clamp(_mm_blendv_pd(_mm_blendv_pd(main, rest, is1), low, is0)));
+		}
+
+		convertScalar(table, hues + k, valuesS + k, valuesI + k, count - k, valuesR + k, valuesG + k, valuesB + k);
+	}
+#endif
+
+#ifdef IMG_SIMD_AVX2
+	IMG_TARGET("avx2")
+	static inline __m256d clamp(__m256d value)
+	{
+		value = _mm256_max_pd(_mm256_setzero_pd(), _mm256_min_pd(_mm256_set1_pd(1.0), value));
+		return _mm256_mul_pd(value, _mm256_set1_pd(255.0));
+	}
+
+	IMG_TARGET("avx2")
+	static void convertAvx2(const HueTable &table, const int *sectors, const double *ratios, const byte *hues, const double *valuesS,
+		const double *valuesI, int count, double *valuesR, double *valuesG, double *valuesB)
+	{
+		const __m256d one = _mm256_set1_pd(1.0);
+		const __m256d three = _mm256_set1_pd(3.0);
+		const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+		int k = 0;
+		for(; k + 8 <= count; k += 8)
+		{
+			__m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(hues + k)));
+			__m256i sector = _mm256_mask_i32gather_epi32(_mm256_setzero_si256(), sectors, index, _mm256_set1_epi32(-1), 4);
+
+			for(int half = 0; half < 2; half++)
+			{
+				int first = k + half * 4;
+				__m128i halfIndex = half == 0 ? _mm256_castsi256_si128(index) : _mm256_extracti128_si256(index, 1);
+				__m256i halfSector = _mm256_cvtepi32_epi64(half == 0 ? _mm256_castsi256_si128(sector) : _mm256_extracti128_si256(sector, 1));
+
+				__m256d ratio = _mm256_mask_i32gather_pd(_mm256_setzero_pd(), ratios, halfIndex, all, 8);
+				__m256d is0 = _mm256_castsi256_pd(_mm256_cmpeq_epi64(halfSector, _mm256_setzero_si256()));
+				__m256d is1 = _mm256_castsi256_pd(_mm256_cmpeq_epi64(halfSector, _mm256_set1_epi64x(1)));
+
+				__m256d s = _mm256_loadu_pd(valuesS + first);
+				__m256d i = _mm256_loadu_pd(valuesI + first);
+
+				__m256d low = _mm256_mul_pd(i, _mm256_sub_pd(one, s));
+				__m256d main = _mm256_mul_pd(i, _mm256_add_pd(one, _mm256_mul_pd(s, ratio)));
+				__m256d rest = _mm256_sub_pd(_mm256_mul_pd(three, i), _mm256_add_pd(main, low));
+
+				_mm256_storeu_pd(valuesR + first, clamp(_mm256_blendv_pd(_mm256_blendv_pd(rest, low, is1), main, is0)));
+				_mm256_storeu_pd(valuesG + first, clamp(_mm256_blendv_pd(_mm256_blendv_pd(low, main, is1), rest, is0)));
+				_mm256_storeu_pd(valuesB + first, clamp(_mm256_blendv_pd(_mm256_blendv_pd(main, rest, is1), low, is0)));
+			}
+		}
+
+		convertScalar(table, hues + k, valuesS + k, valuesI + k, count - k, valuesR + k, valuesG + k, valuesB + k);
+	}
+#endif
+
+	void HueTable::convertRow(PixelUnpacker::Kernel kernel, const byte *hues, const double *valuesS, const double *valuesI, int count,
+		double *valuesR, double *valuesG, double *valuesB) const
+	{
+		switch(kernel)
+		{
+#ifdef IMG_SIMD_AVX2
+		case PixelUnpacker::avx2:
+			convertAvx2(*this, sectors, ratios, hues, valuesS, valuesI, count, valuesR, valuesG, valuesB);
+			break;
+#endif
+#ifdef IMG_SIMD_SSE41
+		case PixelUnpacker::sse41:
+			convertSse41(*this, sectors, ratios, hues, valuesS, valuesI, count, valuesR, valuesG, valuesB);
+			break;
+#endif
+		default:
+			convertScalar(*this, hues, valuesS, valuesI, count, valuesR, valuesG, valuesB);
+		}
+	}
+
+	void HueTable::convertRow(const byte *hues, const double *valuesS, const double *valuesI, int count,
+		double *valuesR, double *valuesG, double *valuesB) const
+	{
+		static const PixelUnpacker::Kernel kernel = PixelUnpacker::bestKernel();
+
+		convertRow(kernel, hues, valuesS, valuesI, count, valuesR, valuesG, valuesB);
+	}
+}
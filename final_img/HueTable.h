@@ -0,0 +1,145 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef HUETABLE_H
+#define HUETABLE_H
+
+#include "HSIColorTable.h"
+#include "PixelUnpacker.h"
+
+namespace img
+{
+	/**
+	* La parte de la conversi&oacute;n de HSI a RGB que depende s&oacute;lo del mat&iacute;z, calculada para los 256 valores
+	* de bch3. El mat&iacute;z de un pixel es hCurve[bch3], por lo que basta guardar para cada bch3 el sector de
+	* 120 grados donde cae y la raz&oacute;n cos(h) / cos(PI / 3 - h) (con h relativo al sector). Con la tabla, la
+	* conversi&oacute;n de un pixel son unas pocas multiplicaciones y sumas, sin funciones trigonom&eacute;tricas.
+	*
+	* En cada sector el canal principal es I * (1 + S * raz&oacute;n), el anterior I * (1 - S) y el restante
+	* 3 * I menos los otros dos:
+	* <pre>
+	* sector 0: R principal, B = I * (1 - S), G restante
+	* sector 1: G principal, R = I * (1 - S), B restante
+	* sector 2: B principal, G = I * (1 - S), R restante
+	* </pre>
+	* El resultado es el de Format::convertHSI2RGB(double, double, double, double*) salvo el redondeo del
+	* &uacute;ltimo bit al multiplicar S por la raz&oacute;n ya calculada.
+	*
+	* convertRow convierte un tramo de pixeles consecutivos de una fila. Las versiones AVX2 (8 pixeles por
+	* iteraci&oacute;n) y SSE4.1 (2 pixeles) eligen el canal de cada valor seg&uacute;n el sector con mezclas
+	* (blend) en lugar de saltos; la versi&oacute;n escalar es convert(int, double, double, double*) pixel por pixel
+	* y sirve de referencia. Todas dan exactamente los mismos valores.
+	*/
+	class HueTable
+	{
+	public:
+		/**
+		* Cantidad de valores de bch3.
+		*/
+		static const int size = 256;
+
+	private:
+		/**
+		* El sector de cada valor de bch3: 0, 1 o 2.
+		*/
+		int sectors[size];
+
+		/**
+		* La raz&oacute;n cos(h) / cos(PI / 3 - h) de cada valor de bch3, con h relativo a su sector.
+		*/
+		double ratios[size];
+
+	public:
+		/**
+		* Constructor de la clase. Calcula la tabla con la tabla de colores compilada en el programa.
+		*/
+		HueTable();
+
+		/**
+		* Constructor de la clase.
+		* @param table La tabla de colores; se utilizan los valores de mat&iacute;z con su precisi&oacute;n.
+		*/
+		HueTable(const HSIColorTable &table);
+
+		/**
+		* Calcula de nuevo la tabla para otra tabla de colores.
+		* @param table La tabla de colores.
+		*/
+		void build(const HSIColorTable &table);
+
+		/**
+		* El sector de un valor de bch3.
+		*/
+		inline int getSector(int hue) const { return this->sectors[hue]; }
+
+		/**
+		* La raz&oacute;n de un valor de bch3.
+		*/
+		inline double getRatio(int hue) const { return this->ratios[hue]; }
+
+		/**
+		* Convierte a RGB un tramo de pixeles consecutivos.
+		* @param kernel La versi&oacute;n que se utiliza; debe estar soportada por el procesador.
+		* @param hues Los valores de bch3 de los pixeles.
+		* @param valuesS Los valores de saturaci&oacute;n.
+		* @param valuesI Los valores de intensidad.
+		* @param count Cantidad de pixeles.
+		* @param valuesR Los valores de rojo, entre 0 y 255.
+		* @param valuesG Los valores de verde, entre 0 y 255.
+		* @param valuesB Los valores de azul, entre 0 y 255.
+		*/
+		void convertRow(PixelUnpacker::Kernel kernel, const byte *hues, const double *valuesS, const double *valuesI, int count,
+			double *valuesR, double *valuesG, double *valuesB) const;
+
+		/**
+		* Convierte a RGB un tramo de pixeles con la mejor versi&oacute;n del procesador.
+		* @see convertRow(PixelUnpacker::Kernel, const byte*, const double*, const double*, int, double*, double*, double*)
+		*/
+		void convertRow(const byte *hues, const double *valuesS, const double *valuesI, int count,
+			double *valuesR, double *valuesG, double *valuesB) const;
+
+		/**
+		* Convierte a RGB un pixel.
+		* @param hue El valor de bch3 del pixel.
+		* @param valueS El valor de la componente de saturaci&oacute;n.
+		* @param valueI El valor de la componente de intensidad.
+		* @param rgb Un arreglo de tres valores donde se escribe el resultado, [0] = Rojo, [1] = Verde, [2] = Azul.
+		*/
+		inline void convert(int hue, double valueS, double valueI, double *rgb) const
+		{
+			int sector = sectors[hue];
+
+			double low = valueI * (1 - valueS);
+			double main = valueI * (1 + valueS * ratios[hue]);
+			double rest = 3 * valueI - (main + low);
+
+			//El canal principal es el del sector, el restante el siguiente y el menor el anterior
+			double values[3];
+			values[sector] = main;
+			values[sector == 2 ? 0 : sector + 1] = rest;
+			values[sector == 0 ? 2 : sector - 1] = low;
+
+			for(int c = 0; c < 3; c++)
+			{
+				double value = values[c] > 1 ? 1 : values[c];
+				value = value < 0 ? 0 : value;
+				rgb[c] = value * 255;
+			}
+		}
+	};
+}
+
+#endif // HUETABLE_H
@@ -58,18 +58,18 @@ namespace img
 		/**
 		* N&uacute;mero del byte donde comienza la estructura.
 		*/
-		long getStartByte() { return this->startByte; }
+		long getStartByte() const { return this->startByte; }
 
 		/**
 		* Tama&ntilde;o en bytes de la columna. Cantidad de bytes que codifican la columna.
 		*/
-		int getColumnLength() { return this->columnLength; }
+		int getColumnLength() const { return this->columnLength; }
 
 		/**
 		* Longitud de fondo. Cantidad de bytes que hay que desplazarse desde el inicio de una columna
 		* para encontrar la primera posici&oacute;n de datos de la imagen.
 		*/
-		int getZeroPadding() { return this->zeroPadding; }
+		int getZeroPadding() const { return this->zeroPadding; }
 	};
 }
 #endif // IMAGEDATACONTROL_H
@@ -0,0 +1,75 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef IMAGEHEADER_H
+#define IMAGEHEADER_H
+
+#include <string>
+
+typedef unsigned char byte;
+
+namespace img
+{
+	/**
+	* Los datos de la cabecera de un fichero IMG, sin los datos de la imagen.
+	*/
+	struct ImageHeader
+	{
+		/**
+		* Identificador del tipo de formato del archivo IMG: 0 si es un formato inv&aacute;lido, 1 si es formato 1, 2 si es formato 2.
+		*/
+		byte formatType;
+
+		/**
+		* El modelo del equipo de Rayos X.
+		*/
+		std::string model;
+
+		/**
+		* La fecha en que fue creado el archivo IMG.
+		*/
+		std::string date;
+
+		/**
+		* El identificador interno del sistema por cada equipo de Rayos X.
+		*/
+		std::string systemId;
+
+		/**
+		* El n&uacute;mero de secuencia. S&oacute;lo para el formato 1.
+		*/
+		double sequenceNumber;
+
+		/**
+		* El ancho de la imagen.
+		*/
+		int width;
+
+		/**
+		* El alto de la imagen seg&uacute;n la cabecera.
+		*/
+		int height;
+
+		/**
+		* La intensidad en K/V de los rayos X del equipo. S&oacute;lo para el formato 1.
+		*/
+		double rayIntensity;
+
+		ImageHeader() :formatType(0), sequenceNumber(0.0), width(0), height(0), rayIntensity(0.0) {}
+	};
+}
+
+#endif // IMAGEHEADER_H
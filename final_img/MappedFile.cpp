@@ -0,0 +1,102 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace img
+{
+#ifdef _WIN32
+	MappedFile::MappedFile(const char *path) :data(NULL), size(0), fileHandle(NULL), mappingHandle(NULL)
+	{
+		HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+		if(file == INVALID_HANDLE_VALUE)
+			return;
+
+		fileHandle = file;
+
+		LARGE_INTEGER fileSize;
+		if(!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+			return;
+
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(mapping == NULL)
+			return;
+
+		mappingHandle = mapping;
+
+		void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if(view == NULL)
+			return;
+
+		data = static_cast<const byte*>(view);
+		size = (size_t)fileSize.QuadPart;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if(data != NULL)
+			UnmapViewOfFile(data);
+
+		if(mappingHandle != NULL)
+			CloseHandle(mappingHandle);
+
+		if(fileHandle != NULL)
+			CloseHandle(fileHandle);
+	}
+#else
+	MappedFile::MappedFile(const char *path) :data(NULL), size(0), fileDescriptor(-1)
+	{
+		fileDescriptor = open(path, O_RDONLY);
+		if(fileDescriptor < 0)
+			return;
+
+		struct stat info;
+		if(fstat(fileDescriptor, &info) != 0 || info.st_size == 0)
+			return;
+
+		void *view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if(view == MAP_FAILED)
+			return;
+
+		//Los bytes se recorren una sola vez desde el inicio hasta el final del fichero
+		madvise(view, (size_t)info.st_size, MADV_SEQUENTIAL);
+		madvise(view, (size_t)info.st_size, MADV_WILLNEED);
+
+		data = static_cast<const byte*>(view);
+		size = (size_t)info.st_size;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if(data != NULL)
+			munmap(const_cast<byte*>(data), size);
+
+		if(fileDescriptor >= 0)
+			close(fileDescriptor);
+	}
+#endif
+}
@@ -0,0 +1,91 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <stddef.h>
+
+typedef unsigned char byte;
+
+namespace img
+{
+	/**
+	* Proyecci&oacute;n en memoria de s&oacute;lo lectura de un fichero. Permite leer los bytes del fichero IMG
+	* directamente desde la cach&eacute; de p&aacute;ginas del sistema operativo, sin copiarlos a un vector.
+	* El acceso se anuncia como secuencial (madvise en POSIX, FILE_FLAG_SEQUENTIAL_SCAN en Windows).
+	*/
+	class MappedFile
+	{
+	private:
+		/**
+		* Puntero al primer byte de la proyecci&oacute;n, NULL si el fichero no pudo ser proyectado.
+		*/
+		const byte *data;
+
+		/**
+		* Cantidad de bytes proyectados.
+		*/
+		size_t size;
+
+#ifdef _WIN32
+		/**
+		* Manipuladores del fichero y de la proyecci&oacute;n en Windows.
+		*/
+		void *fileHandle;
+		void *mappingHandle;
+#else
+		/**
+		* Descriptor del fichero en POSIX.
+		*/
+		int fileDescriptor;
+#endif
+
+		MappedFile(const MappedFile &);
+		MappedFile &operator=(const MappedFile &);
+
+	public:
+		/**
+		* Constructor de la clase. Proyecta el fichero completo en memoria. Luego de creado el objeto se debe
+		* llamar el m&eacute;todo isOpen() para comprobar que la proyecci&oacute;n se realiz&oacute; correctamente.
+		* @param path La direcci&oacute;n del fichero.
+		* @see isOpen()
+		*/
+		MappedFile(const char *path);
+
+		/**
+		* Destructor de la clase. Libera la proyecci&oacute;n y cierra el fichero.
+		*/
+		~MappedFile();
+
+		/**
+		* Indica si el fichero fue proyectado en memoria.
+		*/
+		inline bool isOpen() const { return this->data != NULL; }
+
+		/**
+		* Puntero al primer byte del fichero proyectado.
+		*/
+		inline const byte *getData() const { return this->data; }
+
+		/**
+		* Cantidad de bytes del fichero proyectado.
+		*/
+		inline size_t getSize() const { return this->size; }
+	};
+}
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,341 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include "PixelUnpacker.h"
+#include "Simd.h"
+
+namespace img
+{
+	/**
+	* Cantidad de pixeles que se decodifican por bloque en las versiones que guardan los &iacute;ndices.
+	*/
+	static const int blockSize = 256;
+
+	/**
+	* Valor m&aacute;ximo de bch3 en el &iacute;ndice de la matriz de saturaci&oacute;n.
+	*/
+	static const int bch3Control = 32;
+
+	static void unpackScalar(const byte *pixels, int count, int32_t *indexH, int32_t *indexI, int32_t *indexS)
+	{
+		for(int k = 0; k < count; k++, pixels += 4)
+		{
+			int bch0 = pixels[0];
+			int bch1 = pixels[1];
+			int bch3 = pixels[3];
+
+			indexH[k] = bch3;
+			indexI[k] = (bch1 << 3) + (bch0 >> 5);
+			indexS[k] = indexI[k] * (bch3Control + 1) + (bch3 > bch3Control ? bch3Control : bch3);
+		}
+	}
+
+#ifdef IMG_SIMD_SSE41
+	IMG_TARGET("sse4.1")
+	static void unpackSse41(const byte *pixels, int count, int32_t *indexH, int32_t *indexI, int32_t *indexS)
+	{
+		const __m128i maskI = _mm_set1_epi32(0x7FF);
+		const __m128i control = _mm_set1_epi32(bch3Control);
+
+		int k = 0;
+		for(; k + 4 <= count; k += 4)
+		{
+			//Cada pixel es un entero little-endian: bch1 << 3 + bch0 >> 5 son los bits 5 a 15
+			__m128i lane = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + k * 4));
+			__m128i valueI = _mm_and_si128(_mm_srli_epi32(lane, 5), maskI);
+			__m128i valueH = _mm_srli_epi32(lane, 24);
+			__m128i valueS = _mm_add_epi32(_mm_add_epi32(_mm_slli_epi32(valueI, 5), valueI), _mm_min_epi32(valueH, control));
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(indexH + k), valueH);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(indexI + k), valueI);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(indexS + k), valueS);
+		}
+
+		unpackScalar(pixels + k * 4, count - k, indexH + k, indexI + k, indexS + k);
+	}
+#endif
+
+#ifdef IMG_SIMD_AVX2
+	IMG_TARGET("avx2")
+	static void unpackAvx2(const byte *pixels, int count, int32_t *indexH, int32_t *indexI, int32_t *indexS)
+	{
+		const __m256i maskI = _mm256_set1_epi32(0x7FF);
+		const __m256i control = _mm256_set1_epi32(bch3Control);
+
+		int k = 0;
+		for(; k + 8 <= count; k += 8)
+		{
+			__m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + k * 4));
+			__m256i valueI = _mm256_and_si256(_mm256_srli_epi32(lane, 5), maskI);
+			__m256i valueH = _mm256_srli_epi32(lane, 24);
+			__m256i valueS = _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(valueI, 5), valueI), _mm256_min_epi32(valueH, control));
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(indexH + k), valueH);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(indexI + k), valueI);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(indexS + k), valueS);
+		}
+
+		unpackScalar(pixels + k * 4, count - k, indexH + k, indexI + k, indexS + k);
+	}
+
+	/**
+	* Lee 8 valores de una tabla con los &iacute;ndices dados y los guarda como double.
+	*/
+	IMG_TARGET("avx2")
+	static inline void gather(const double *table, __m256i index, double *values)
+	{
+		const __m256d all = _mm256_castsi256_pd(_mm256_set1_epi64x(-1));
+
+		_mm256_storeu_pd(values, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), table, _mm256_castsi256_si128(index), all, 8));
+		_mm256_storeu_pd(values + 4, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), table, _mm256_extracti128_si256(index, 1), all, 8));
+	}
+
+	IMG_TARGET("avx2")
+	static inline void gather(const float *table, __m256i index, double *values)
+	{
+		const __m256 all = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+		__m256 result = _mm256_mask_i32gather_ps(_mm256_setzero_ps(), table, index, all, 4);
+		_mm256_storeu_pd(values, _mm256_cvtps_pd(_mm256_castps256_ps128(result)));
+		_mm256_storeu_pd(values + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(result, 1)));
+	}
+
+	IMG_TARGET("avx2")
+	static inline void gather(const uint16_t *table, __m256i index, double *values)
+	{
+		const __m256i all = _mm256_set1_epi32(-1);
+		const __m256i low = _mm256_set1_epi32(0xFFFF);
+		const __m256d scale = _mm256_set1_pd(1.0 / HSIColorTable::fixedOne);
+
+		//No hay gather de 16 bits: se leen 32 bits desde cada valor y se descartan los 16 superiores
+		__m256i result = _mm256_and_si256(_mm256_mask_i32gather_epi32(_mm256_setzero_si256(), reinterpret_cast<const int*>(table), index, all, 2), low);
+		_mm256_storeu_pd(values, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(result)), scale));
+		_mm256_storeu_pd(values + 4, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(result, 1)), scale));
+	}
+
+	template<typename T>
+	IMG_TARGET("avx2")
+	static void decodeAvx2(const byte *pixels, int count, const T *hCurve, const T *iCurve, const T *sMatrix, double *valuesH, double *valuesS, double *valuesI)
+	{
+		const __m256i maskI = _mm256_set1_epi32(0x7FF);
+		const __m256i control = _mm256_set1_epi32(bch3Control);
+
+		for(int k = 0; k + 8 <= count; k += 8)
+		{
+			__m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + k * 4));
+			__m256i valueI = _mm256_and_si256(_mm256_srli_epi32(lane, 5), maskI);
+			__m256i valueH = _mm256_srli_epi32(lane, 24);
+			__m256i valueS = _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(valueI, 5), valueI), _mm256_min_epi32(valueH, control));
+
+			//Los &iacute;ndices no salen de los registros: se leen las tablas con gather
+			if(valuesH != NULL)
+				gather(hCurve, valueH, valuesH + k);
+			gather(iCurve, valueI, valuesI + k);
+			gather(sMatrix, valueS, valuesS + k);
+		}
+	}
+
+	IMG_TARGET("avx2")
+	static void decodeFusedAvx2(const byte *pixels, int count, const uint16_t *fused, double *valuesH, double *valuesS, double *valuesI)
+	{
+		const __m256i maskI = _mm256_set1_epi32(0x7FF);
+		const __m256i control = _mm256_set1_epi32(bch3Control);
+		const __m256i all = _mm256_set1_epi64x(-1);
+		const __m256d scale = _mm256_set1_pd(1.0 / HSIColorTable::fixedOne);
+		const long long *entries = reinterpret_cast<const long long*>(fused);
+
+		//Agrupa los valores de 16 bits de dos entradas (H0 S0 I0 0 H1 S1 I1 0) como H0 H1 S0 S1 I0 I1 0 0
+		const __m256i group = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15,
+			0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+		//Junta los pares de las dos mitades: H0 H1 H2 H3 S0 S1 S2 S3 | I0 I1 I2 I3 0 0 0 0
+		const __m256i join = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+		for(int k = 0; k + 8 <= count; k += 8)
+		{
+			__m256i lane = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pixels + k * 4));
+			__m256i valueI = _mm256_and_si256(_mm256_srli_epi32(lane, 5), maskI);
+			__m256i valueH = _mm256_srli_epi32(lane, 24);
+			__m256i valueS = _mm256_add_epi32(_mm256_add_epi32(_mm256_slli_epi32(valueI, 5), valueI), _mm256_min_epi32(valueH, control));
+
+			for(int half = 0; half < 2; half++)
+			{
+				__m128i index = half == 0 ? _mm256_castsi256_si128(valueS) : _mm256_extracti128_si256(valueS, 1);
+
+				//Una entrada de 8 bytes por pixel: H, S e I llegan juntos
+				__m256i entry = _mm256_mask_i32gather_epi64(_mm256_setzero_si256(), entries, index, all, 8);
+				entry = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(entry, group), join);
+
+				__m128i low = _mm256_castsi256_si128(entry);
+				__m128i high = _mm256_extracti128_si256(entry, 1);
+				int offset = k + half * 4;
+
+				if(valuesH != NULL)
+					_mm256_storeu_pd(valuesH + offset, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_cvtepu16_epi32(low)), scale));
+				_mm256_storeu_pd(valuesS + offset, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_cvtepu16_epi32(_mm_srli_si128(low, 8))), scale));
+				_mm256_storeu_pd(valuesI + offset, _mm256_mul_pd(_mm256_cvtepi32_pd(_mm_cvtepu16_epi32(high)), scale));
+			}
+		}
+	}
+#endif
+
+	/**
+	* Lee los valores de las tablas para un bloque de &iacute;ndices.
+	* @param scale El valor por el que se multiplican los valores de las tablas.
+	*/
+	template<typename T>
+	static inline void lookup(const int32_t *indexH, const int32_t *indexI, const int32_t *indexS, int count,
+		const T *hCurve, const T *iCurve, const T *sMatrix, double scale, double *valuesH, double *valuesS, double *valuesI)
+	{
+		if(valuesH == NULL)
+		{
+			for(int k = 0; k < count; k++)
+			{
+				valuesI[k] = iCurve[indexI[k]] * scale;
+				valuesS[k] = sMatrix[indexS[k]] * scale;
+			}
+
+			return;
+		}
+
+		for(int k = 0; k < count; k++)
+		{
+			valuesH[k] = hCurve[indexH[k]] * scale;
+			valuesI[k] = iCurve[indexI[k]] * scale;
+			valuesS[k] = sMatrix[indexS[k]] * scale;
+		}
+	}
+
+	/**
+	* Lee los valores de la tabla combinada para un bloque de &iacute;ndices de la matriz de saturaci&oacute;n.
+	*/
+	static inline void lookupFused(const int32_t *indexS, int count, const uint16_t *fused, double *valuesH, double *valuesS, double *valuesI)
+	{
+		const double scale = 1.0 / HSIColorTable::fixedOne;
+
+		for(int k = 0; k < count; k++)
+		{
+			const uint16_t *entry = fused + (size_t)indexS[k] * 4;
+			if(valuesH != NULL)
+				valuesH[k] = entry[0] * scale;
+			valuesS[k] = entry[1] * scale;
+			valuesI[k] = entry[2] * scale;
+		}
+	}
+
+	PixelUnpacker::Kernel PixelUnpacker::bestKernel(void)
+	{
+#if defined(IMG_SIMD_AVX2) && defined(__GNUC__)
+		if(__builtin_cpu_supports("avx2"))
+			return avx2;
+#elif defined(IMG_SIMD_AVX2) && defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		int maxLeaf = info[0];
+
+		__cpuid(info, 1);
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+
+		//AVX2 necesita adem&aacute;s que el sistema operativo guarde los registros YMM
+		if(maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6)
+		{
+			__cpuidex(info, 7, 0);
+			if(info[1] & (1 << 5))
+				return avx2;
+		}
+#endif
+
+#if defined(IMG_SIMD_SSE41) && defined(__GNUC__)
+		if(__builtin_cpu_supports("sse4.1"))
+			return sse41;
+#elif defined(IMG_SIMD_SSE41) && defined(_MSC_VER)
+		int features[4];
+		__cpuid(features, 1);
+		if(features[2] & (1 << 19))
+			return sse41;
+#endif
+
+		return scalar;
+	}
+
+	void PixelUnpacker::unpack(Kernel kernel, const byte *pixels, int count, int32_t *indexH, int32_t *indexI, int32_t *indexS)
+	{
+		switch(kernel)
+		{
+#ifdef IMG_SIMD_AVX2
+		case avx2:
+			unpackAvx2(pixels, count, indexH, indexI, indexS);
+			break;
+#endif
+#ifdef IMG_SIMD_SSE41
+		case sse41:
+			unpackSse41(pixels, count, indexH, indexI, indexS);
+			break;
+#endif
+		default:
+			unpackScalar(pixels, count, indexH, indexI, indexS);
+		}
+	}
+
+	void PixelUnpacker::decode(const byte *pixels, int count, const HSIColorTable &table, double *valuesH, double *valuesS, double *valuesI)
+	{
+		static const Kernel kernel = bestKernel();
+
+		decode(kernel, pixels, count, table, valuesH, valuesS, valuesI);
+	}
+
+	void PixelUnpacker::decode(Kernel kernel, const byte *pixels, int count, const HSIColorTable &table, double *valuesH, double *valuesS, double *valuesI)
+	{
+		HSIColorTable::Precision precision = table.getPrecision();
+		int first = 0;
+
+#ifdef IMG_SIMD_AVX2
+		if(kernel == avx2)
+		{
+			if(precision == HSIColorTable::singlePrecision)
+				decodeAvx2(pixels, count, table.hCurveSingle, table.iCurveSingle, table.sMatrixSingle, valuesH, valuesS, valuesI);
+			else if(precision == HSIColorTable::fixedPoint16)
+				decodeAvx2(pixels, count, table.hCurveFixed, table.iCurveFixed, table.sMatrixFixed, valuesH, valuesS, valuesI);
+			else if(precision == HSIColorTable::fusedFixed16)
+				decodeFusedAvx2(pixels, count, table.fused, valuesH, valuesS, valuesI);
+			else
+				decodeAvx2(pixels, count, table.hCurve, table.iCurve, table.sMatrix, valuesH, valuesS, valuesI);
+
+			//Los &uacute;ltimos pixeles, menos de 8, se decodifican con la versi&oacute;n escalar
+			first = count & ~7;
+		}
+#endif
+
+		int32_t indexH[blockSize], indexI[blockSize], indexS[blockSize];
+
+		for(; first < count; first += blockSize)
+		{
+			int size = count - first < blockSize ? count - first : blockSize;
+			unpack(kernel, pixels + first * 4, size, indexH, indexI, indexS);
+
+			double *blockH = valuesH == NULL ? NULL : valuesH + first;
+
+			if(precision == HSIColorTable::singlePrecision)
+				lookup(indexH, indexI, indexS, size, table.hCurveSingle, table.iCurveSingle, table.sMatrixSingle, 1.0, blockH, valuesS + first, valuesI + first);
+			else if(precision == HSIColorTable::fixedPoint16)
+				lookup(indexH, indexI, indexS, size, table.hCurveFixed, table.iCurveFixed, table.sMatrixFixed, 1.0 / HSIColorTable::fixedOne, blockH, valuesS + first, valuesI + first);
+			else if(precision == HSIColorTable::fusedFixed16)
+				lookupFused(indexS, size, table.fused, blockH, valuesS + first, valuesI + first);
+			else
+				lookup(indexH, indexI, indexS, size, table.hCurve, table.iCurve, table.sMatrix, 1.0, blockH, valuesS + first, valuesI + first);
+		}
+	}
+}
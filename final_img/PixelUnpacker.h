@@ -0,0 +1,91 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef PIXELUNPACKER_H
+#define PIXELUNPACKER_H
+
+#include <stdint.h>
+#include "HSIColorTable.h"
+
+typedef unsigned char byte;
+
+namespace img
+{
+	/**
+	* Decodifica los pixeles de 4 bytes de una columna del campo de datos en bloque. Para cada pixel
+	* (bch0, bch1, bch2, bch3) se calculan los &iacute;ndices de las tablas de HSIColorTable:
+	* <pre>
+	* indexH = bch3
+	* indexI = (bch1 << 3) + (bch0 >> 5)
+	* indexS = indexI * 33 + min(bch3, 32)
+	* </pre>
+	* y luego se leen los valores de las tablas. Hay versiones AVX2 (8 pixeles por iteraci&oacute;n y lectura
+	* de las tablas con gather), SSE4.1 (4 pixeles por iteraci&oacute;n) y escalar; la versi&oacute;n se elige al
+	* ejecutar seg&uacute;n el procesador. Todas dan exactamente los mismos valores. Las tablas se leen con la
+	* precisi&oacute;n de HSIColorTable (double, float o punto fijo de 16 bits, en tablas separadas o en la tabla
+	* combinada) y los valores se devuelven en double.
+	*/
+	class PixelUnpacker
+	{
+	public:
+		/**
+		* Versiones de las funciones de decodificaci&oacute;n.
+		*/
+		enum Kernel
+		{
+			scalar,
+			sse41,
+			avx2
+		};
+
+		/**
+		* La mejor versi&oacute;n que soporta el procesador.
+		*/
+		static Kernel bestKernel(void);
+
+		/**
+		* Calcula los &iacute;ndices de las tablas de un bloque de pixeles.
+		* @param kernel La versi&oacute;n que se utiliza; debe estar soportada por el procesador.
+		* @param pixels El primer byte del primer pixel.
+		* @param count Cantidad de pixeles.
+		* @param indexH Los &iacute;ndices de la curva de mat&iacute;z.
+		* @param indexI Los &iacute;ndices de la curva de intensidad.
+		* @param indexS Los &iacute;ndices de la matriz de saturaci&oacute;n.
+		*/
+		static void unpack(Kernel kernel, const byte *pixels, int count, int32_t *indexH, int32_t *indexI, int32_t *indexS);
+
+		/**
+		* Decodifica los valores HSI de un bloque de pixeles con la mejor versi&oacute;n del procesador.
+		* @param pixels El primer byte del primer pixel.
+		* @param count Cantidad de pixeles.
+		* @param table La tabla de colores HSI.
+		* @param valuesH Los valores de mat&iacute;z, o NULL si no se necesitan (por ejemplo si el color se calcula con
+		* HueTable, que s&oacute;lo necesita bch3): as&iacute; no se lee la curva de mat&iacute;z.
+		* @param valuesS Los valores de saturaci&oacute;n.
+		* @param valuesI Los valores de intensidad.
+		*/
+		static void decode(const byte *pixels, int count, const HSIColorTable &table, double *valuesH, double *valuesS, double *valuesI);
+
+		/**
+		* Decodifica los valores HSI de un bloque de pixeles con la versi&oacute;n dada.
+		* @param kernel La versi&oacute;n que se utiliza; debe estar soportada por el procesador.
+		* @see decode(const byte*, int, const HSIColorTable&, double*, double*, double*)
+		*/
+		static void decode(Kernel kernel, const byte *pixels, int count, const HSIColorTable &table, double *valuesH, double *valuesS, double *valuesI);
+	};
+}
+
+#endif // PIXELUNPACKER_H
@@ -0,0 +1,54 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#include <algorithm>
+#include "RGBImage.h"
+
+namespace img
+{
+	RGBImage::RGBImage() :width(0), height(0)
+	{
+	}
+
+	void RGBImage::resize(int width, int height)
+	{
+		this->width = width;
+		this->height = height;
+
+		size_t size = (size_t)width * height;
+		valuesR.resize(size);
+		valuesG.resize(size);
+		valuesB.resize(size);
+
+		rowsR.resize(height);
+		rowsG.resize(height);
+		rowsB.resize(height);
+
+		for(int k = 0; k < height; k++)
+		{
+			rowsR[k] = size == 0 ? 0 : &valuesR[(size_t)k * width];
+			rowsG[k] = size == 0 ? 0 : &valuesG[(size_t)k * width];
+			rowsB[k] = size == 0 ? 0 : &valuesB[(size_t)k * width];
+		}
+	}
+
+	void RGBImage::fill(double value)
+	{
+		std::fill(valuesR.begin(), valuesR.end(), value);
+		std::fill(valuesG.begin(), valuesG.end(), value);
+		std::fill(valuesB.begin(), valuesB.end(), value);
+	}
+}
@@ -0,0 +1,98 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef RGBIMAGE_H
+#define RGBIMAGE_H
+
+#include <vector>
+
+namespace img
+{
+	/**
+	* Imagen en RGB con un arreglo bidimensional por canal, con la misma forma que los canales de Format
+	* ([fila][columna], valores entre 0 y 255). Los valores de cada canal se guardan en un solo bloque de
+	* memoria que s&oacute;lo crece, por lo que un mismo objeto puede reutilizarse para im&aacute;genes sucesivas.
+	*/
+	class RGBImage
+	{
+	private:
+		/**
+		* El ancho de la imagen.
+		*/
+		int width;
+
+		/**
+		* El alto de la imagen.
+		*/
+		int height;
+
+		/**
+		* Los valores de cada canal, fila por fila.
+		*/
+		std::vector<double> valuesR, valuesG, valuesB;
+
+		/**
+		* Punteros al inicio de cada fila de cada canal.
+		*/
+		std::vector<double*> rowsR, rowsG, rowsB;
+
+	public:
+		/**
+		* Constructor de la clase. Crea una imagen vac&iacute;a.
+		*/
+		RGBImage();
+
+		/**
+		* Cambia el tama&ntilde;o de la imagen. Los valores anteriores no se conservan.
+		* @param width El ancho de la imagen.
+		* @param height El alto de la imagen.
+		*/
+		void resize(int width, int height);
+
+		/**
+		* Asigna el mismo valor a todos los pixeles de los tres canales.
+		* @param value El valor.
+		*/
+		void fill(double value);
+
+		/**
+		* El ancho de la imagen.
+		*/
+		inline int getWidth() const { return this->width; }
+
+		/**
+		* El alto de la imagen.
+		*/
+		inline int getHeight() const { return this->height; }
+
+		/**
+		* El arreglo bidimensional(matriz) del canal de Rojo.
+		*/
+		inline double **getChannelR() { return this->rowsR.empty() ? 0 : &this->rowsR[0]; }
+
+		/**
+		* El arreglo bidimensional(matriz) del canal de Verde.
+		*/
+		inline double **getChannelG() { return this->rowsG.empty() ? 0 : &this->rowsG[0]; }
+
+		/**
+		* El arreglo bidimensional(matriz) del canal de Azul.
+		*/
+		inline double **getChannelB() { return this->rowsB.empty() ? 0 : &this->rowsB[0]; }
+	};
+}
+
+#endif // RGBIMAGE_H
@@ -0,0 +1,135 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef RAWPIXELVIEW_H
+#define RAWPIXELVIEW_H
+
+#include <stddef.h>
+#include "ColumnIndex.h"
+
+typedef unsigned char byte;
+
+namespace img
+{
+	/**
+	* Vista de s&oacute;lo lectura de los bytes sin decodificar de los pixeles del campo de datos, con la misma
+	* forma ([fila][columna]) que los canales de Format. No copia los bytes: cada pixel apunta a sus 4 bytes
+	* (canales 0 a 3) dentro de la columna del fichero IMG, y los pixeles de una columna est&aacute;n separados
+	* por pixelStride bytes. Los pixeles de fondo no tienen bytes.
+	*
+	* La vista es v&aacute;lida mientras exista el objeto Format que la cre&oacute; y no se pidan m&aacute;s bytes a su
+	* origen (por ejemplo con otra llamada de Format sobre un StreamSource).
+	*/
+	class RawPixelView
+	{
+	private:
+		/**
+		* El primer byte del fichero IMG.
+		*/
+		const byte *data;
+
+		/**
+		* El &iacute;ndice de las columnas del campo de datos.
+		*/
+		const ColumnIndex *columnIndex;
+
+		/**
+		* El ancho de la imagen.
+		*/
+		int width;
+
+		/**
+		* El alto de la imagen.
+		*/
+		int height;
+
+	public:
+		/**
+		* Cantidad de bytes de cada pixel y distancia entre dos pixeles consecutivos de una columna.
+		*/
+		static const int pixelStride = 4;
+
+		/**
+		* Constructor de la clase. Los bytes de todas las columnas del &iacute;ndice deben estar disponibles.
+		* @param data El primer byte del fichero IMG.
+		* @param columnIndex El &iacute;ndice de las columnas del campo de datos.
+		* @param width El ancho de la imagen; las columnas que no est&aacute;n en el &iacute;ndice son de fondo.
+		* @param height El alto de la imagen.
+		*/
+		RawPixelView(const byte *data, const ColumnIndex &columnIndex, int width, int height);
+
+		/**
+		* El ancho de la imagen.
+		*/
+		inline int getWidth() const { return this->width; }
+
+		/**
+		* El alto de la imagen.
+		*/
+		inline int getHeight() const { return this->height; }
+
+		/**
+		* Longitud de fondo de una columna: la fila de su primer pixel con datos.
+		*/
+		inline int getZeroPadding(int column) const { return (size_t)column < columnIndex->size() ? (*columnIndex)[column].getZeroPadding() : 0; }
+
+		/**
+		* Cantidad de pixeles con datos de una columna.
+		*/
+		inline int getColumnLength(int column) const { return (size_t)column < columnIndex->size() ? (*columnIndex)[column].getColumnLength() : 0; }
+
+		/**
+		* Los bytes del primer pixel con datos de una columna, que est&aacute; en la fila getZeroPadding(int).
+		* @return NULL si la columna no tiene pixeles con datos.
+		*/
+		inline const byte *getColumn(int column) const
+		{
+			return getColumnLength(column) == 0 ? NULL : data + (*columnIndex)[column].getStartByte() + 7;
+		}
+
+		/**
+		* Los 4 bytes de un pixel.
+		* @param row La fila del pixel.
+		* @param column La columna del pixel.
+		* @return NULL si el pixel es de fondo.
+		*/
+		inline const byte *getPixel(int row, int column) const
+		{
+			int zeroPadding = getZeroPadding(column);
+
+			if(row < zeroPadding || row >= zeroPadding + getColumnLength(column))
+				return NULL;
+
+			return getColumn(column) + (size_t)(row - zeroPadding) * pixelStride;
+		}
+
+		/**
+		* Un byte de un pixel.
+		* @param row La fila del pixel.
+		* @param column La columna del pixel.
+		* @param channel El canal, de 0 a 3.
+		* @return El valor del canal, 0 si el pixel es de fondo.
+		*/
+		inline byte getChannel(int row, int column, int channel) const
+		{
+			const byte *pixel = getPixel(row, column);
+
+			return pixel == NULL ? 0 : pixel[channel];
+		}
+	};
+}
+
+#endif // RAWPIXELVIEW_H
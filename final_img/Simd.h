@@ -0,0 +1,42 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef SIMD_H
+#define SIMD_H
+
+/**
+* Instrucciones SIMD disponibles para el compilador. IMG_SIMD_SSE41 e IMG_SIMD_AVX2 indican que se pueden
+* compilar funciones con esas instrucciones; si el procesador las soporta se decide al ejecutar
+* (PixelUnpacker::bestKernel). IMG_TARGET(isa) marca una funci&oacute;n compilada para esas instrucciones: en GCC
+* es necesario, en Visual C++ los intr&iacute;nsecos se pueden usar en cualquier funci&oacute;n.
+*/
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define IMG_SIMD_SSE41
+#define IMG_SIMD_AVX2
+#define IMG_TARGET(isa) __attribute__((target(isa)))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <smmintrin.h>
+#define IMG_SIMD_SSE41
+#if _MSC_VER >= 1700
+#include <immintrin.h>
+#define IMG_SIMD_AVX2
+#endif
+#define IMG_TARGET(isa)
+#endif
+
+#endif // SIMD_H
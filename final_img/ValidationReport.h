@@ -0,0 +1,101 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+#ifndef VALIDATIONREPORT_H
+#define VALIDATIONREPORT_H
+
+#include <stddef.h>
+
+namespace img
+{
+	/**
+	* El resultado de comprobar la estructura de un fichero IMG sin decodificar la imagen.
+	*/
+	struct ValidationReport
+	{
+		/**
+		* Estados de un fichero IMG o de una columna de su campo de datos.
+		*/
+		enum Status
+		{
+			/**
+			* El fichero (o la columna) es correcto.
+			*/
+			valid,
+
+			/**
+			* El fichero no es de formato IMG.
+			*/
+			invalidFormat,
+
+			/**
+			* El fichero termina antes del final de la cabecera.
+			*/
+			truncatedHeader,
+
+			/**
+			* El fichero termina entre dos columnas, antes de tener tantas columnas como el ancho de la imagen.
+			*/
+			missingColumns,
+
+			/**
+			* El fichero termina dentro de una columna: faltan bytes de su estructura o de sus pixeles.
+			*/
+			truncatedColumn,
+
+			/**
+			* La longitud de fondo m&aacute;s el tama&ntilde;o de una columna es mayor que el alto de la imagen.
+			*/
+			columnTooTall
+		};
+
+		/**
+		* El estado del fichero.
+		*/
+		Status status;
+
+		/**
+		* Cantidad de columnas correctas desde el inicio del campo de datos, las que se decodifican en
+		* Format::loadImageData(int).
+		*/
+		int validColumns;
+
+		/**
+		* Cantidad de columnas que deber&iacute;a tener el fichero: el ancho de la imagen.
+		*/
+		int expectedColumns;
+
+		/**
+		* La posici&oacute;n (desde 0) del primer byte donde los datos dejan de ser correctos: el inicio de la
+		* estructura de la columna incorrecta, o el tama&ntilde;o del fichero si faltan bytes de la cabecera.
+		*/
+		size_t errorByte;
+
+		/**
+		* El tama&ntilde;o del fichero.
+		*/
+		size_t fileSize;
+
+		ValidationReport() :status(valid), validColumns(0), expectedColumns(0), errorByte(0), fileSize(0) {}
+
+		/**
+		* Indica si el fichero es correcto.
+		*/
+		inline bool isValid() const { return this->status == valid; }
+	};
+}
+
+#endif // VALIDATIONREPORT_H
@@ -0,0 +1,133 @@
+/**
+* Licensed under the Apache License, Version 2.0 (the "License"); you may not
+* use this file except in compliance with the License. You may obtain a copy of
+* the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+* WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+* License for the specific language governing permissions and limitations under
+* the License.
+*
+* Created by Felipe Rodriguez Arias <ucifarias@gmail.com>.
+*/
+
+/**
+* Mide el tiempo de PixelUnpacker::decode con cada versi&oacute;n que soporta el procesador (escalar, SSE4.1,
+* AVX2) y cada precisi&oacute;n de HSIColorTable, con y sin los valores de mat&iacute;z. Los pixeles son
+* aleatorios, con una semilla fija para que las mediciones se puedan repetir. Antes de medir se comprueba que
+* cada versi&oacute;n da los mismos valores que la escalar. Se informa la mejor de varias mediciones, para
+* reducir el efecto de otros procesos del equipo.
+*
+* Uso: unpack_benchmark [pixeles] [repeticiones]
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <vector>
+
+#include "PixelUnpacker.h"
+
+using namespace img;
+
+/**
+* Generador congruencial lineal: da los mismos pixeles en todos los compiladores, a diferencia de rand().
+*/
+static uint32_t nextRandom(uint32_t &state)
+{
+	state = state * 1664525u + 1013904223u;
+	return state >> 24;
+}
+
+/**
+* Cantidad de mediciones de cada versi&oacute;n.
+*/
+static const int runs = 5;
+
+/**
+* Mide el tiempo por pixel de una decodificaci&oacute;n, repetida repeats veces en cada medici&oacute;n.
+* @return Nanosegundos por pixel de la mejor medici&oacute;n.
+*/
+static double measure(PixelUnpacker::Kernel kernel, const std::vector<byte> &pixels, int count, int repeats, const HSIColorTable &table,
+	double *valuesH, double *valuesS, double *valuesI)
+{
+	//Una decodificaci&oacute;n previa para que las tablas est&eacute;n en la cach&eacute;
+	PixelUnpacker::decode(kernel, &pixels[0], count, table, valuesH, valuesS, valuesI);
+
+	double best = 0;
+
+	for(int r = 0; r < runs; r++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		for(int k = 0; k < repeats; k++)
+			PixelUnpacker::decode(kernel, &pixels[0], count, table, valuesH, valuesS, valuesI);
+
+		std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(r == 0 || elapsed.count() < best)
+			best = elapsed.count();
+	}
+
+	return best / repeats / count;
+}
+
+int main(int argc, char **argv)
+{
+	int count = argc > 1 ? atoi(argv[1]) : 16384;
+	int repeats = argc > 2 ? atoi(argv[2]) : 1000;
+
+	if(count <= 0 || repeats <= 0)
+	{
+		fprintf(stderr, "Uso: %s [pixeles] [repeticiones]\n", argv[0]);
+		return 1;
+	}
+
+	std::vector<byte> pixels((size_t)count * 4);
+	uint32_t state = 12345;
+	for(size_t k = 0; k < pixels.size(); k++)
+		pixels[k] = (byte)nextRandom(state);
+
+	const char *kernelNames[] = {"escalar", "SSE4.1", "AVX2"};
+	const char *precisionNames[] = {"double", "float", "fixed16", "fused16"};
+	const HSIColorTable::Precision precisions[] = {HSIColorTable::doublePrecision, HSIColorTable::singlePrecision,
+		HSIColorTable::fixedPoint16, HSIColorTable::fusedFixed16};
+
+	PixelUnpacker::Kernel best = PixelUnpacker::bestKernel();
+
+	std::vector<double> valuesH(count), valuesS(count), valuesI(count);
+	std::vector<double> expectedH(count), expectedS(count), expectedI(count);
+
+	printf("%d pixeles, %d repeticiones, mejor de %d mediciones (ns por pixel)\n\n", count, repeats, runs);
+	printf("%-8s %-8s %10s %10s\n", "tabla", "version", "con H", "sin H");
+
+	for(int p = 0; p < 4; p++)
+	{
+		HSIColorTable table(precisions[p]);
+
+		PixelUnpacker::decode(PixelUnpacker::scalar, &pixels[0], count, table, &expectedH[0], &expectedS[0], &expectedI[0]);
+
+		for(int k = PixelUnpacker::scalar; k <= best; k++)
+		{
+			PixelUnpacker::Kernel kernel = (PixelUnpacker::Kernel)k;
+
+			PixelUnpacker::decode(kernel, &pixels[0], count, table, &valuesH[0], &valuesS[0], &valuesI[0]);
+			if(valuesH != expectedH || valuesS != expectedS || valuesI != expectedI)
+			{
+				fprintf(stderr, "La version %s con la tabla %s no da los valores de la version escalar.\n", kernelNames[k], precisionNames[p]);
+				return 1;
+			}
+
+			double withHue = measure(kernel, pixels, count, repeats, table, &valuesH[0], &valuesS[0], &valuesI[0]);
+			double withoutHue = measure(kernel, pixels, count, repeats, table, NULL, &valuesS[0], &valuesI[0]);
+
+			printf("%-8s %-8s %10.2f %10.2f\n", precisionNames[p], kernelNames[k], withHue, withoutHue);
+		}
+	}
+
+	return 0;
+}